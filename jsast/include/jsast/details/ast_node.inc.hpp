@@ -11,6 +11,10 @@ void node::impl<node_type, enabled>::write_to(generator& g) const {
 template <typename node_type, typename callback_type, typename enabled>
 void node::impl_with_callback<node_type, callback_type, enabled>::write_to(
     generator& g) const {
+  if (g._measuring) {
+    node::impl<node_type, enabled>::write_to(g);
+    return;
+  }
   _callback(g.with_range(
       [this, &g]() { node::impl<node_type, enabled>::write_to(g); }));
 }
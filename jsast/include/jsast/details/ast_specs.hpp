@@ -10,6 +10,8 @@ namespace jsast {
 
 static constexpr size_t precedence_needs_parentheses{17};
 
+// The map is built once under the thread-safe static initialization guarantee
+// and never modified afterwards, so lookups may run concurrently.
 inline size_t precedence_for_type(std::type_index node) noexcept {
   static const std::unordered_map<std::type_index, size_t> precedence_map{
       // Definitions
@@ -0,0 +1,79 @@
+#ifndef jsast_deflate_sink_hpp
+#define jsast_deflate_sink_hpp
+
+#include <memory>
+#include <string>
+
+#include "sink.hpp"
+
+namespace jsast {
+
+// Compresses generated code with zlib while it is being written, so the raw
+// text is never held in full. Compressed bytes either accumulate in
+// compressed() or are passed on to a downstream sink (e.g. a rope).
+struct deflate_sink : sink {
+  enum class format { zlib, gzip, raw };
+
+  struct options {
+    // zlib level, 0 (store) to 9 (best), or -1 for the zlib default
+    int level{-1};
+    format type{format::gzip};
+    // Input is staged and handed to zlib in blocks of this size
+    size_t buffer_size{16 << 10};
+    // Emits a sync flush after this many input bytes so that a consumer can
+    // decode progressively; 0 flushes only on finish()
+    size_t flush_every{0};
+  };
+
+  explicit deflate_sink(options opts);
+  explicit deflate_sink(sink& downstream, options opts);
+  inline deflate_sink() : deflate_sink{options{}} {}
+  explicit inline deflate_sink(sink& downstream)
+      : deflate_sink{downstream, options{}} {}
+  ~deflate_sink() noexcept override;
+
+  deflate_sink(const deflate_sink&) = delete;
+  deflate_sink& operator=(const deflate_sink&) = delete;
+
+  void append(const char* data, size_t size) override;
+
+  // Makes everything appended so far decodable by the consumer.
+  void flush();
+  // Writes the stream trailer; further appends are not allowed.
+  void finish();
+
+  [[nodiscard]] inline bool finished() const noexcept { return _finished; }
+  [[nodiscard]] inline size_t uncompressed_size() const noexcept {
+    return _uncompressed_size;
+  }
+  [[nodiscard]] inline size_t compressed_size() const noexcept {
+    return _compressed_size;
+  }
+
+  // Compressed output when no downstream sink was given.
+  [[nodiscard]] inline const std::string& compressed() const& {
+    return _output;
+  }
+  [[nodiscard]] inline std::string compressed() && {
+    return std::move(_output);
+  }
+
+ private:
+  struct stream;
+
+  std::unique_ptr<stream> _stream;
+  sink* _downstream{nullptr};
+  options _options;
+  std::string _pending;
+  std::string _output;
+  size_t _since_flush{0};
+  size_t _uncompressed_size{0};
+  size_t _compressed_size{0};
+  bool _finished{false};
+
+  void deflate_pending(int mode);
+};
+
+}  // namespace jsast
+
+#endif  // jsast_deflate_sink_hpp
@@ -2,10 +2,12 @@
 #define jsast_generator_hpp
 
 #include <sstream>
+#include <string_view>
 #include <type_traits>
 
 #include "ast.hpp"
 #include "ast_specs.hpp"
+#include "sink.hpp"
 #include "source_loc.hpp"
 #include "utils.hpp"
 
@@ -17,24 +19,61 @@ struct generator {
   template <typename, typename, typename>
   friend struct ast::node::impl_with_callback;
 
-  struct {
+  struct config_type {
     std::string indent{"  "};
     std::string line_end{"\n"};
   } config;
 
+  inline generator() noexcept = default;
+  // Sends all output to target instead of the internal buffer, in which case
+  // str() and view() stay empty.
+  explicit inline generator(sink& target) noexcept : _sink{&target} {}
+
   template <typename node_type>
   inline void write(const node_type& node) {
     write_statement(node);
   }
 
+  // Computes the exact number of bytes write(node) would append, without
+  // writing anything or invoking source range callbacks.
+  template <typename node_type>
+  [[nodiscard]] inline size_t measure(const node_type& node) const {
+    generator counter;
+    counter.config = config;
+    counter._indent_level = _indent_level;
+    counter._measuring = true;
+    counter.write(node);
+    return counter._measured;
+  }
+
+  inline void reserve(size_t size) { _buffer.reserve(size); }
+
+  // Clears the output but keeps the allocated buffer for the next use.
+  inline void reset() noexcept {
+    _buffer.clear();
+    _loc = {1, 1};
+    _indent_level = 0;
+  }
+
+  [[nodiscard]] inline size_t capacity() const noexcept {
+    return _buffer.capacity();
+  }
+
+  [[nodiscard]] inline std::string_view view() const noexcept {
+    return _buffer;
+  }
   [[nodiscard]] inline std::string str() const& { return _buffer; }
   [[nodiscard]] inline std::string str() && { return std::move(_buffer); }
 
  private:
   std::string _buffer;
+  sink* _sink{nullptr};
   source_loc _loc{1, 1};
   size_t _indent_level{0};
 
+  bool _measuring{false};
+  size_t _measured{0};
+
   template <typename callable_type>
   [[nodiscard]] inline source_range with_range(callable_type callable) {
     const auto start{_loc};
@@ -0,0 +1,80 @@
+#ifndef jsast_generator_pool_hpp
+#define jsast_generator_pool_hpp
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "generator.hpp"
+
+namespace jsast {
+
+// Keeps reset generators around so that their warmed buffers can be reused by
+// later requests. acquire() and release are safe to call from many threads.
+struct generator_pool {
+  struct handle {
+    friend generator_pool;
+
+    inline handle(handle&& other) noexcept
+        : _pool{other._pool}, _gen{std::move(other._gen)} {}
+    inline handle& operator=(handle&& other) noexcept {
+      release();
+      _pool = other._pool;
+      _gen = std::move(other._gen);
+      return *this;
+    }
+    inline ~handle() { release(); }
+
+    [[nodiscard]] inline generator& operator*() const { return *_gen; }
+    [[nodiscard]] inline generator* operator->() const { return _gen.get(); }
+
+   private:
+    generator_pool* _pool;
+    std::unique_ptr<generator> _gen;
+
+    inline handle(generator_pool& pool, std::unique_ptr<generator> gen)
+        : _pool{&pool}, _gen{std::move(gen)} {}
+
+    inline void release() {
+      if (_gen) {
+        _pool->release(std::move(_gen));
+      }
+    }
+  };
+
+  // Configuration applied to every generator handed out.
+  generator::config_type config;
+
+  // max_idle bounds the generators kept between uses, and generators whose
+  // buffer grew beyond max_capacity are dropped instead of being kept.
+  explicit inline generator_pool(size_t max_idle = 16,
+                                 size_t max_capacity = 16 << 20)
+      : _max_idle{max_idle}, _max_capacity{max_capacity} {}
+
+  generator_pool(const generator_pool&) = delete;
+  generator_pool& operator=(const generator_pool&) = delete;
+
+  [[nodiscard]] handle acquire();
+
+  // Like acquire(), but with the buffer reserved for the exact size of node.
+  template <typename node_type>
+  [[nodiscard]] inline handle acquire_for(const node_type& node) {
+    auto gen{acquire()};
+    gen->reserve(gen->measure(node));
+    return gen;
+  }
+
+  [[nodiscard]] size_t idle() const;
+
+ private:
+  mutable std::mutex _mutex;
+  std::vector<std::unique_ptr<generator>> _idle;
+  size_t _max_idle;
+  size_t _max_capacity;
+
+  void release(std::unique_ptr<generator> gen);
+};
+
+}  // namespace jsast
+
+#endif  // jsast_generator_pool_hpp
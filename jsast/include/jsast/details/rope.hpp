@@ -0,0 +1,63 @@
+#ifndef jsast_rope_hpp
+#define jsast_rope_hpp
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "sink.hpp"
+
+namespace jsast {
+
+// Output buffer made of fixed-size chunks. Appending never moves bytes that
+// were already written, so generation stays linear in the output size.
+struct rope : sink {
+  explicit inline rope(size_t chunk_size = 64 << 10)
+      : _chunk_size{chunk_size > 0 ? chunk_size : 1} {}
+
+  rope(const rope&) = delete;
+  rope& operator=(const rope&) = delete;
+  inline rope(rope&&) noexcept = default;
+  inline rope& operator=(rope&&) noexcept = default;
+
+  void append(const char* data, size_t size) override;
+
+  [[nodiscard]] inline size_t size() const noexcept { return _size; }
+  [[nodiscard]] inline size_t chunk_size() const noexcept {
+    return _chunk_size;
+  }
+
+  // Filled chunks in order, e.g. to build an iovec array for writev or to feed
+  // a hash or compressor. Views are invalidated by clear().
+  [[nodiscard]] std::vector<std::string_view> chunks() const;
+
+  template <typename callback_type>
+  inline void for_each_chunk(callback_type callback) const {
+    auto remaining{_size};
+    for (const auto& chunk : _chunks) {
+      if (remaining == 0) {
+        break;
+      }
+      const auto length{std::min(remaining, _chunk_size)};
+      callback(std::string_view{chunk.get(), length});
+      remaining -= length;
+    }
+  }
+
+  // Copies everything into one contiguous string.
+  [[nodiscard]] std::string flatten() const;
+
+  // Drops the contents but keeps the allocated chunks for reuse.
+  inline void clear() noexcept { _size = 0; }
+
+ private:
+  size_t _chunk_size;
+  size_t _size{0};
+  std::vector<std::unique_ptr<char[]>> _chunks;
+};
+
+}  // namespace jsast
+
+#endif  // jsast_rope_hpp
@@ -0,0 +1,18 @@
+#ifndef jsast_sink_hpp
+#define jsast_sink_hpp
+
+#include <cstddef>
+
+namespace jsast {
+
+// Destination for generated code when the generator should not accumulate it
+// in its own contiguous buffer.
+struct sink {
+  virtual ~sink() noexcept = default;
+
+  virtual void append(const char* data, size_t size) = 0;
+};
+
+}  // namespace jsast
+
+#endif  // jsast_sink_hpp
@@ -0,0 +1,43 @@
+#ifndef jsast_utf16_sink_hpp
+#define jsast_utf16_sink_hpp
+
+#include <string>
+#include <string_view>
+
+#include "sink.hpp"
+
+namespace jsast {
+
+// Collects generated code as UTF-16 code units, e.g. for engines whose native
+// string representation is UTF-16. Sequences split across appends are carried
+// over, and malformed input, including overlong forms and encoded surrogates,
+// is replaced with U+FFFD. Call finish() once generation is done, so that a
+// sequence cut off at the end is replaced as well.
+struct utf16_sink : sink {
+  inline utf16_sink() = default;
+
+  void append(const char* data, size_t size) override;
+  void finish();
+
+  inline void reserve(size_t size) { _buffer.reserve(size); }
+
+  [[nodiscard]] inline std::u16string_view view() const noexcept {
+    return _buffer;
+  }
+  [[nodiscard]] inline std::u16string str() const& { return _buffer; }
+  [[nodiscard]] inline std::u16string str() && { return std::move(_buffer); }
+
+ private:
+  std::u16string _buffer;
+  char32_t _code_point{0};
+  // Smallest code point the pending sequence may encode; lower ones are
+  // overlong
+  char32_t _minimum{0};
+  size_t _remaining{0};
+
+  void push(char32_t code_point);
+};
+
+}  // namespace jsast
+
+#endif  // jsast_utf16_sink_hpp
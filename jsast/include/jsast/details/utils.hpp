@@ -1,7 +1,6 @@
 #ifndef jsast_utils_hpp
 #define jsast_utils_hpp
 
-#include <sstream>
 #include <string>
 #include <vector>
 
@@ -27,74 +26,78 @@ struct move_vector : std::vector<elem_type> {
   }
 };
 
+// Both quoting helpers build into a plain string rather than a stream, which
+// would take the shared global locale on every construction.
 [[nodiscard]] inline std::string quoted(const std::string& str) {
-  std::ostringstream oss;
-  oss << '"';
+  std::string result;
+  result.reserve(str.size() + 2);
+  result += '"';
   for (size_t i{0}; i < str.size(); i++) {
     const auto c{static_cast<uint8_t>(str[i])};
     switch (c) {
       case '\t':
-        oss << "\\t";
+        result += "\\t";
         break;
       case '\n':
-        oss << "\\n";
+        result += "\\n";
         break;
       case '\b':
-        oss << "\\b";
+        result += "\\b";
         break;
       case '\r':
-        oss << "\\r";
+        result += "\\r";
         break;
       case '\v':
-        oss << "\\v";
+        result += "\\v";
         break;
       case '\f':
-        oss << "\\f";
+        result += "\\f";
         break;
       case '"':
-        oss << "\\\"";
+        result += "\\\"";
         break;
       case '\\':
-        oss << "\\\\";
+        result += "\\\\";
         break;
       default:
-        oss << c;
+        result += static_cast<char>(c);
         break;
     }
   }
-  oss << '"';
-  return oss.str();
+  result += '"';
+  return result;
 }
 
 [[nodiscard]] inline std::string backquoted(const std::string& str) {
-  std::ostringstream oss;
+  std::string result;
+  result.reserve(str.size());
   for (size_t i{0}; i < str.size(); i++) {
     const auto c{static_cast<uint8_t>(str[i])};
     switch (c) {
       case '\b':
-        oss << "\\b";
+        result += "\\b";
         break;
       case '\r':
-        oss << "\\r";
+        result += "\\r";
         break;
       case '\v':
-        oss << "\\v";
+        result += "\\v";
         break;
       case '\f':
-        oss << "\\f";
+        result += "\\f";
         break;
       case '`':
-        oss << "\\`";
+        result += "\\`";
         break;
       case '\\':
-        oss << "\\\\";
+        result += "\\\\";
         break;
       default:
-        oss << c;
+        result += static_cast<char>(c);
         break;
     }
   }
-  return oss.str();
+  return result;
 }
 
 }  // namespace jsast::utils
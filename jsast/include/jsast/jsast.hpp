@@ -6,9 +6,14 @@
 #define jsast_hpp
 
 #include "details/ast.hpp"
+#include "details/deflate_sink.hpp"
 #include "details/generator.hpp"
+#include "details/generator_pool.hpp"
+#include "details/rope.hpp"
+#include "details/sink.hpp"
 #include "details/source_loc.hpp"
 #include "details/specs.hpp"
+#include "details/utf16_sink.hpp"
 
 #include "details/ast_node.inc.hpp"
 
@@ -0,0 +1,112 @@
+#include "deflate_sink.hpp"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+#include <zlib.h>
+
+namespace jsast {
+
+struct deflate_sink::stream {
+  z_stream z{};
+};
+
+[[nodiscard]] static int window_bits_for(deflate_sink::format type) noexcept {
+  switch (type) {
+    case deflate_sink::format::zlib:
+      return MAX_WBITS;
+    case deflate_sink::format::gzip:
+      return MAX_WBITS + 16;
+    case deflate_sink::format::raw:
+      return -MAX_WBITS;
+  }
+  return MAX_WBITS;
+}
+
+deflate_sink::deflate_sink(options opts)
+    : _stream{std::make_unique<stream>()}, _options{opts} {
+  if (_options.buffer_size == 0) {
+    _options.buffer_size = 1;
+  }
+  _pending.reserve(_options.buffer_size);
+  if (deflateInit2(&_stream->z, _options.level, Z_DEFLATED,
+                   window_bits_for(_options.type), 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    throw std::invalid_argument{"jsast::deflate_sink: invalid options"};
+  }
+}
+
+deflate_sink::deflate_sink(sink& downstream, options opts)
+    : deflate_sink{opts} {
+  _downstream = &downstream;
+}
+
+deflate_sink::~deflate_sink() noexcept { deflateEnd(&_stream->z); }
+
+void deflate_sink::append(const char* data, size_t size) {
+  if (_finished) {
+    throw std::logic_error{"jsast::deflate_sink: append after finish"};
+  }
+  _uncompressed_size += size;
+  while (size > 0) {
+    const auto length{std::min(size, _options.buffer_size - _pending.size())};
+    _pending.append(data, length);
+    data += length;
+    size -= length;
+    if (_pending.size() == _options.buffer_size) {
+      deflate_pending(Z_NO_FLUSH);
+    }
+  }
+}
+
+void deflate_sink::flush() {
+  if (!_finished) {
+    deflate_pending(Z_SYNC_FLUSH);
+  }
+}
+
+void deflate_sink::finish() {
+  if (!_finished) {
+    deflate_pending(Z_FINISH);
+    _finished = true;
+  }
+}
+
+void deflate_sink::deflate_pending(int mode) {
+  _since_flush += _pending.size();
+  if (mode == Z_NO_FLUSH && _options.flush_every > 0 &&
+      _since_flush >= _options.flush_every) {
+    mode = Z_SYNC_FLUSH;
+  }
+  if (mode != Z_NO_FLUSH) {
+    _since_flush = 0;
+  }
+
+  auto& z{_stream->z};
+  z.next_in = reinterpret_cast<Bytef*>(_pending.data());
+  z.avail_in = static_cast<uInt>(_pending.size());
+
+  std::array<char, 16 << 10> chunk;
+  int status;
+  do {
+    z.next_out = reinterpret_cast<Bytef*>(chunk.data());
+    z.avail_out = static_cast<uInt>(chunk.size());
+    status = deflate(&z, mode);
+    if (status == Z_STREAM_ERROR) {
+      throw std::runtime_error{"jsast::deflate_sink: deflate failed"};
+    }
+
+    const auto produced{chunk.size() - z.avail_out};
+    _compressed_size += produced;
+    if (_downstream != nullptr) {
+      _downstream->append(chunk.data(), produced);
+    } else {
+      _output.append(chunk.data(), produced);
+    }
+  } while (z.avail_out == 0);
+
+  _pending.clear();
+}
+
+}  // namespace jsast
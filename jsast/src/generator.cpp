@@ -3,7 +3,16 @@
 namespace jsast {
 
 void generator::write_raw(const std::string& str) {
-  _buffer.append(str);
+  if (_measuring) {
+    _measured += str.size();
+    return;
+  }
+
+  if (_sink != nullptr) {
+    _sink->append(str.data(), str.size());
+  } else {
+    _buffer.append(str);
+  }
 
   // UTF-8 line counting
   for (size_t i{0}; i < str.length(); i++) {
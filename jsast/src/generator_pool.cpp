@@ -0,0 +1,38 @@
+#include "generator_pool.hpp"
+
+namespace jsast {
+
+generator_pool::handle generator_pool::acquire() {
+  std::unique_ptr<generator> gen;
+  {
+    const std::lock_guard<std::mutex> lock{_mutex};
+    if (!_idle.empty()) {
+      gen = std::move(_idle.back());
+      _idle.pop_back();
+    }
+  }
+  if (!gen) {
+    gen = std::make_unique<generator>();
+  }
+  gen->config = config;
+  return {*this, std::move(gen)};
+}
+
+size_t generator_pool::idle() const {
+  const std::lock_guard<std::mutex> lock{_mutex};
+  return _idle.size();
+}
+
+void generator_pool::release(std::unique_ptr<generator> gen) {
+  if (gen->capacity() > _max_capacity) {
+    return;
+  }
+  gen->reset();
+
+  const std::lock_guard<std::mutex> lock{_mutex};
+  if (_idle.size() < _max_idle) {
+    _idle.push_back(std::move(gen));
+  }
+}
+
+}  // namespace jsast
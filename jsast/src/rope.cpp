@@ -0,0 +1,38 @@
+#include "rope.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace jsast {
+
+void rope::append(const char* data, size_t size) {
+  while (size > 0) {
+    const auto offset{_size % _chunk_size};
+    const auto index{_size / _chunk_size};
+    if (index == _chunks.size()) {
+      _chunks.push_back(std::make_unique<char[]>(_chunk_size));
+    }
+
+    const auto length{std::min(size, _chunk_size - offset)};
+    std::memcpy(_chunks[index].get() + offset, data, length);
+    _size += length;
+    data += length;
+    size -= length;
+  }
+}
+
+std::vector<std::string_view> rope::chunks() const {
+  std::vector<std::string_view> result;
+  result.reserve((_size + _chunk_size - 1) / _chunk_size);
+  for_each_chunk([&result](auto chunk) { result.push_back(chunk); });
+  return result;
+}
+
+std::string rope::flatten() const {
+  std::string result;
+  result.reserve(_size);
+  for_each_chunk([&result](auto chunk) { result.append(chunk); });
+  return result;
+}
+
+}  // namespace jsast
@@ -0,0 +1,66 @@
+#include "utf16_sink.hpp"
+
+#include <cstdint>
+
+namespace jsast {
+
+static constexpr char32_t replacement_character{0xFFFD};
+
+void utf16_sink::append(const char* data, size_t size) {
+  for (size_t i{0}; i < size; i++) {
+    const auto c{static_cast<uint8_t>(data[i])};
+
+    if (_remaining > 0) {
+      if ((c & 0xC0) == 0x80) {
+        _code_point = (_code_point << 6) | (c & 0x3F);
+        if (--_remaining == 0) {
+          push(_code_point < _minimum ? replacement_character : _code_point);
+        }
+        continue;
+      }
+      // Truncated sequence, re-read c as a lead byte
+      _remaining = 0;
+      push(replacement_character);
+    }
+
+    if (c < 0x80) {
+      _buffer.push_back(static_cast<char16_t>(c));
+    } else if ((c & 0xE0) == 0xC0) {
+      _code_point = c & 0x1F;
+      _minimum = 0x80;
+      _remaining = 1;
+    } else if ((c & 0xF0) == 0xE0) {
+      _code_point = c & 0x0F;
+      _minimum = 0x800;
+      _remaining = 2;
+    } else if ((c & 0xF8) == 0xF0) {
+      _code_point = c & 0x07;
+      _minimum = 0x10000;
+      _remaining = 3;
+    } else {
+      push(replacement_character);
+    }
+  }
+}
+
+void utf16_sink::finish() {
+  if (_remaining > 0) {
+    _remaining = 0;
+    push(replacement_character);
+  }
+}
+
+void utf16_sink::push(char32_t code_point) {
+  if (code_point > 0x10FFFF ||
+      (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+    _buffer.push_back(static_cast<char16_t>(replacement_character));
+  } else if (code_point >= 0x10000) {
+    code_point -= 0x10000;
+    _buffer.push_back(static_cast<char16_t>(0xD800 + (code_point >> 10)));
+    _buffer.push_back(static_cast<char16_t>(0xDC00 + (code_point & 0x3FF)));
+  } else {
+    _buffer.push_back(static_cast<char16_t>(code_point));
+  }
+}
+
+}  // namespace jsast
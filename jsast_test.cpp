@@ -140,5 +140,46 @@ int main() {
 
   std::cout << std::move(gen).str();
 
+  jsast::generator_pool pool;
+  const jsast::ast::node statement{
+      jsast::ast::expression_statement{jsast::ast::call_expression{
+          jsast::ast::identifier{"print"},
+          {jsast::ast::string_literal{"pooled\tgenerator"}}}}};
+  for (int i{0}; i < 2; i++) {
+    auto pooled = pool.acquire_for(statement);
+    const auto measured = pooled->measure(statement);
+    pooled->write(statement);
+    std::cout << measured << " " << pooled->view().size() << " "
+              << pool.idle() << "\n";
+  }
+
+  jsast::rope chunks{8};
+  jsast::generator rope_gen{chunks};
+  rope_gen.write(statement);
+  std::cout << chunks.size() << " " << chunks.chunks().size() << " "
+            << chunks.flatten();
+
+  jsast::deflate_sink compressor;
+  jsast::generator deflate_gen{compressor};
+  for (int i{0}; i < 100; i++) {
+    deflate_gen.write(statement);
+  }
+  compressor.finish();
+  std::cout << compressor.uncompressed_size() << " "
+            << (compressor.compressed_size() < compressor.uncompressed_size())
+            << "\n";
+
+  jsast::utf16_sink wide;
+  jsast::generator wide_gen{wide};
+  wide_gen.write(jsast::ast::expression_statement{
+      jsast::ast::string_literal{u8"你好世界 \U0001F600"}});
+  wide.finish();
+  std::cout << wide.view().size() << "\n";
+
+  jsast::utf16_sink malformed;
+  malformed.append("\xC0\x80\xED\xA0\x80\xE4\xBD", 7);
+  malformed.finish();
+  std::cout << malformed.view().size() << "\n";
+
   return 0;
 }
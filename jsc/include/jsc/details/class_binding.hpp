@@ -0,0 +1,219 @@
+#ifndef jsc_class_binding_hpp
+#define jsc_class_binding_hpp
+
+#include <JavaScriptCore/JavaScriptCore.h>
+#include <atomic>
+#include <cassert>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "convert.hpp"
+#include "error.hpp"
+#include "function.hpp"
+#include "instrument.hpp"
+#include "native.hpp"
+#include "profiler.hpp"
+
+namespace jsc {
+
+// Describes how JS sees instances of a C++ type. Methods become static
+// functions on a prototype shared by all instances and accessors become static
+// values, so lookups use the engine's static property tables instead of
+// per-instance closures:
+//   class_binding<point> binding{"Point"};
+//   binding.method<&point::length>("length").property<&point::x>("x");
+//   ctx.root()["p"] = ctx.instance(binding, 3.0, 4.0);
+// The description must be complete before the first instance is created, and
+// only one binding of a type may have created instances at a time.
+template <typename object_type>
+struct class_binding {
+  explicit inline class_binding(std::string name) : _name{std::move(name)} {}
+  inline ~class_binding() {
+    if (_class != nullptr) {
+      auto expected{_class};
+      _bound.compare_exchange_strong(expected, nullptr);
+      JSClassRelease(_class);
+    }
+  }
+
+  class_binding(const class_binding&) = delete;
+  class_binding& operator=(const class_binding&) = delete;
+
+  template <auto member_function>
+  inline class_binding& method(std::string name) {
+    assert(_class == nullptr);
+    _functions.push_back({std::move(name), call_method<member_function>});
+    return *this;
+  }
+
+  // getter is a data member pointer or a const member function; setter is a
+  // member function taking the new value. A data member without an explicit
+  // setter is writable, a getter function without one is read-only.
+  template <auto getter, auto setter = nullptr>
+  inline class_binding& property(std::string name) {
+    assert(_class == nullptr);
+    constexpr auto writable{
+        !std::is_null_pointer_v<decltype(setter)> ||
+        std::is_member_object_pointer_v<decltype(getter)>};
+    if constexpr (writable) {
+      _values.push_back({std::move(name), get_value<getter>,
+                         set_value<getter, setter>, kJSPropertyAttributeNone});
+    } else {
+      _values.push_back({std::move(name), get_value<getter>, nullptr,
+                         kJSPropertyAttributeReadOnly});
+    }
+    return *this;
+  }
+
+  [[nodiscard]] inline JSClassRef ref() const {
+    std::call_once(_created, [this] { create(); });
+    return _class;
+  }
+
+  // The instance behind obj, or nullptr if obj was not created by this binding
+  [[nodiscard]] inline object_type* get(JSContextRef ctx,
+                                        JSValueRef obj) const {
+    if (!JSValueIsObjectOfClass(ctx, obj, ref())) {
+      return nullptr;
+    }
+    return static_cast<object_type*>(
+        JSObjectGetPrivate(const_cast<JSObjectRef>(obj)));
+  }
+
+ private:
+  struct function_entry {
+    std::string name;
+    JSObjectCallAsFunctionCallback callback;
+  };
+  struct value_entry {
+    std::string name;
+    JSObjectGetPropertyCallback getter;
+    JSObjectSetPropertyCallback setter;
+    JSPropertyAttributes attributes;
+  };
+
+  std::string _name;
+  std::vector<function_entry> _functions;
+  std::vector<value_entry> _values;
+  mutable std::once_flag _created;
+  mutable JSClassRef _class{nullptr};
+
+  // Class of the live binding, reachable from the static callbacks, which get
+  // no binding of their own
+  inline static std::atomic<JSClassRef> _bound{nullptr};
+
+  inline void create() const {
+    std::vector<JSStaticFunction> functions;
+    for (const auto& entry : _functions) {
+      functions.push_back({entry.name.c_str(), entry.callback,
+                           kJSPropertyAttributeDontEnum |
+                               kJSPropertyAttributeDontDelete});
+    }
+    functions.push_back({nullptr, nullptr, 0});
+
+    std::vector<JSStaticValue> values;
+    for (const auto& entry : _values) {
+      values.push_back({entry.name.c_str(), entry.getter, entry.setter,
+                        entry.attributes | kJSPropertyAttributeDontDelete});
+    }
+    values.push_back({nullptr, nullptr, nullptr, 0});
+
+    JSClassDefinition def{kJSClassDefinitionEmpty};
+    def.className = _name.c_str();
+    def.attributes = kJSClassAttributeNone;
+    def.staticFunctions = functions.data();
+    def.staticValues = values.data();
+    def.finalize = finalize;
+    _class = JSClassCreate(&def);
+    JSClassRef expected{nullptr};
+    [[maybe_unused]] const auto first{
+        _bound.compare_exchange_strong(expected, _class)};
+    assert(first && "another class_binding of this type is alive");
+  }
+
+  static void finalize(JSObjectRef obj) {
+    delete static_cast<object_type*>(JSObjectGetPrivate(obj));
+  }
+
+  // A method or accessor can be reached through any receiver, e.g. via
+  // call(), and containers and native functions carry private data of other
+  // types, so the receiver's class is checked before its data is used.
+  [[nodiscard]] static inline object_type* self(const native_call& call) {
+    const auto bound{_bound.load(std::memory_order_acquire)};
+    if (bound == nullptr || call.this_object == nullptr ||
+        !JSValueIsObjectOfClass(call.ctx, call.this_object, bound)) {
+      call.throw_type_error("Illegal invocation");
+      return nullptr;
+    }
+    return static_cast<object_type*>(JSObjectGetPrivate(call.this_object));
+  }
+
+  template <auto member_function>
+  static JSValueRef call_method(JSContextRef ctx, JSObjectRef function,
+                                JSObjectRef this_object, size_t argument_count,
+                                const JSValueRef arguments[],
+                                JSValueRef* exception) {
+    const native_call call{
+        ctx, function, this_object, {arguments, argument_count}, exception};
+    const auto instance{self(call)};
+    if (instance == nullptr) {
+      return call.undefined();
+    }
+    const details::entry_scope entry{"native", [ctx, function] {
+      return details::entry_name(ctx, function);
+    }};
+    return details::guard_callback(ctx, exception, JSValueRef{nullptr}, [&] {
+      auto function_ptr{member_function};
+      return details::typed_call<decltype(member_function)>::invoke(
+          function_ptr, call, instance);
+    });
+  }
+
+  template <auto getter>
+  static JSValueRef get_value(JSContextRef ctx, JSObjectRef obj, JSStringRef,
+                              JSValueRef* exception) {
+    const native_call call{ctx, nullptr, obj, {nullptr, 0}, exception};
+    const auto instance{self(call)};
+    if (instance == nullptr) {
+      return nullptr;
+    }
+    return details::guard_callback(ctx, exception, JSValueRef{nullptr}, [&] {
+      using result_type =
+          std::decay_t<decltype(std::invoke(getter, instance))>;
+      return convert<result_type>::to(ctx, std::invoke(getter, instance));
+    });
+  }
+
+  template <auto getter, auto setter>
+  static bool set_value(JSContextRef ctx, JSObjectRef obj, JSStringRef,
+                        JSValueRef val, JSValueRef* exception) {
+    const native_call call{ctx, nullptr, obj, {nullptr, 0}, exception};
+    const auto instance{self(call)};
+    if (instance == nullptr) {
+      return true;
+    }
+    return details::guard_callback(ctx, exception, true, [&] {
+      if constexpr (std::is_null_pointer_v<decltype(setter)>) {
+        using member_type = std::decay_t<decltype(instance->*getter)>;
+        auto converted{convert<member_type>::from(ctx, val, exception)};
+        if (!call.threw()) {
+          instance->*getter = std::move(converted);
+        }
+      } else {
+        using arg_type = std::tuple_element_t<
+            0, typename details::function_traits<decltype(setter)>::args_type>;
+        auto converted{convert<arg_type>::from(ctx, val, exception)};
+        if (!call.threw()) {
+          std::invoke(setter, instance, std::move(converted));
+        }
+      }
+      return true;
+    });
+  }
+};
+
+}  // namespace jsc
+
+#endif  // jsc_class_binding_hpp
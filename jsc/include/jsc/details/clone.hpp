@@ -0,0 +1,35 @@
+#ifndef jsc_clone_hpp
+#define jsc_clone_hpp
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace jsc {
+
+namespace details {
+
+// Memory behind an ArrayBuffer made by context::shared_array_buffer, freed
+// once no buffer or clone refers to it
+struct shared_bytes {
+  std::unique_ptr<uint8_t[]> data;
+  size_t size;
+};
+
+}  // namespace details
+
+// Binary snapshot of a JS value graph made by context::serialize. It does not
+// refer to the source context, so it can be rebuilt by context::deserialize in
+// any context, on any thread. ArrayBuffers made by
+// context::shared_array_buffer are referenced instead of copied, so the source
+// and every rebuilt graph see the same memory.
+struct clone_buffer {
+  std::vector<uint8_t> data;
+  std::vector<std::shared_ptr<details::shared_bytes>> shared;
+
+  [[nodiscard]] inline bool empty() const noexcept { return data.empty(); }
+};
+
+}  // namespace jsc
+
+#endif  // jsc_clone_hpp
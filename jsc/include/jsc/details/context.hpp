@@ -1,12 +1,29 @@
 #ifndef jsc_context_hpp
 #define jsc_context_hpp
 
+#include <chrono>
+#include <iterator>
+#include <memory>
 #include <type_traits>
 #include <vector>
 
+#include "class_binding.hpp"
+#include "clone.hpp"
+#include "convert.hpp"
+#include "error.hpp"
+#include "function.hpp"
+#include "handle_scope.hpp"
+#include "instrument.hpp"
+#include "json.hpp"
+#include "memory.hpp"
+#include "native.hpp"
 #include "object.hpp"
+#include "profiler.hpp"
 #include "property.hpp"
+#include "script.hpp"
 #include "string.hpp"
+#include "time_limit.hpp"
+#include "typed_array.hpp"
 #include "value.hpp"
 
 // Testing
@@ -34,6 +51,9 @@ struct context_group {
 };
 
 struct context {
+  friend struct event_loop;
+  friend struct handle_scope;
+  friend struct time_limit;
   friend struct value;
   friend struct object;
 
@@ -45,12 +65,21 @@ struct context {
   inline context(JSGlobalContextRef ref) : _ref{ref}, _exception{undefined()} {
     JSGlobalContextRetain(_ref);
   }
-  inline ~context() { JSGlobalContextRelease(_ref); }
+  inline ~context() {
+    if (_owns_time_limit) {
+      details::exchange_time_limit(JSContextGetGroup(_ref), 0);
+    }
+    JSGlobalContextRelease(_ref);
+  }
 
   inline context(const context& ctx) : _ref{ctx._ref}, _exception{undefined()} {
     JSGlobalContextRetain(_ref);
   }
   inline context& operator=(const context& ctx) {
+    if (_owns_time_limit) {
+      details::exchange_time_limit(JSContextGetGroup(_ref), 0);
+      _owns_time_limit = false;
+    }
     _ref = ctx._ref;
     JSGlobalContextRetain(_ref);
     return *this;
@@ -78,6 +107,13 @@ struct context {
     return {*this, JSValueMakeString(_ref, js_string.managed_ref())};
   }
   [[nodiscard]] inline value val(object obj) { return obj; }
+  // Any other type with a jsc::convert specialization, such as structs with
+  // declared jsc::fields, vectors, optionals and string-keyed maps
+  template <typename val_type,
+            typename = std::enable_if_t<has_convert<val_type>::value>>
+  [[nodiscard]] inline value val(const val_type& v) {
+    return {*this, convert<val_type>::to(_ref, v)};
+  }
 
   [[nodiscard]] inline value undefined() { return val(jsc::undefined); }
   [[nodiscard]] inline value null() { return val(jsc::null); }
@@ -106,37 +142,90 @@ struct context {
   }
 
   inline static JSClassRef callback_class() {
-    static JSClassRef _callback_class = nullptr;
-    if (_callback_class == nullptr) {
+    static const JSClassRef _callback_class{[] {
       JSClassDefinition def{kJSClassDefinitionEmpty};
       def.className = nullptr;
       def.attributes = kJSClassAttributeNone;
       def.callAsFunction = callback_class_call;
       def.finalize = container_finalize<internal_callback_type>;
-      _callback_class = JSClassCreate(&def);
-    }
+      return JSClassCreate(&def);
+    }()};
     return _callback_class;
   }
 
   // Non-callable
   template <typename object_type>
   inline static JSClassRef container_class() {
-    static JSClassRef _container_class = nullptr;
-    if (_container_class == nullptr) {
+    static const JSClassRef _container_class{[] {
       JSClassDefinition def{kJSClassDefinitionEmpty};
       def.className = nullptr;
       def.attributes = kJSClassAttributeNone;
-      def.finalize = container_finalize<object_type>;
-      _container_class = JSClassCreate(&def);
-    }
+      def.finalize = container_finalize<details::container_box<object_type>>;
+      return JSClassCreate(&def);
+    }()};
     return _container_class;
   }
 
+  template <typename callback_type>
+  static JSValueRef native_class_call(JSContextRef ctx, JSObjectRef function,
+                                      JSObjectRef this_object,
+                                      size_t argument_count,
+                                      const JSValueRef arguments[],
+                                      JSValueRef* exception) {
+    auto& callback{*static_cast<callback_type*>(JSObjectGetPrivate(function))};
+    const native_call call{
+        ctx, function, this_object, {arguments, argument_count}, exception};
+    const details::entry_scope entry{"native", [ctx, function] {
+      return details::entry_name(ctx, function);
+    }};
+    return details::guard_callback(ctx, exception, JSValueRef{nullptr}, [&] {
+      using result_type = std::decay_t<decltype(callback(call))>;
+      if constexpr (std::is_same_v<result_type, void>) {
+        callback(call);
+        return JSValueMakeUndefined(ctx);
+      } else if constexpr (std::is_convertible_v<result_type, JSValueRef>) {
+        return JSValueRef{callback(call)};
+      } else {
+        return convert<result_type>::to(ctx, callback(call));
+      }
+    });
+  }
+
+  // One class per callback type, so the call dispatches statically
+  template <typename callback_type>
+  inline static JSClassRef native_class() {
+    static const JSClassRef _native_class{[] {
+      JSClassDefinition def{kJSClassDefinitionEmpty};
+      def.className = nullptr;
+      def.attributes = kJSClassAttributeNone;
+      def.callAsFunction = native_class_call<callback_type>;
+      def.finalize = container_finalize<callback_type>;
+      return JSClassCreate(&def);
+    }()};
+    return _native_class;
+  }
+
  public:
+  // The object's external_size is reported to the collector, so that large
+  // containers make it run sooner
   template <typename object_type, typename... arg_type>
   inline object container(arg_type&&... args) {
+    details::count(details::counter::container);
+    const auto box{new details::container_box<object_type>{
+        std::forward<arg_type>(args)...}};
+    object result{*this,
+                  JSObjectMake(_ref, container_class<object_type>(), box)};
+    report_external_memory(box->size);
+    return result;
+  }
+
+  // New instance of a bound class, owned by the garbage collector
+  template <typename object_type, typename... arg_type>
+  inline object instance(const class_binding<object_type>& binding,
+                         arg_type&&... args) {
+    details::count(details::counter::instance);
     return {*this,
-            JSObjectMake(_ref, container_class<object_type>(),
+            JSObjectMake(_ref, binding.ref(),
                          new object_type{std::forward<arg_type>(args)...})};
   }
 
@@ -150,6 +239,7 @@ struct context {
       context global_context{JSContextGetGlobalContext(ctx)};
       object this_obj{global_context, this_object};
       std::vector<value> vector;
+      vector.reserve(argument_count);
       for (size_t i = 0; i < argument_count; i++) {
         vector.emplace_back(global_context, arguments[i]);
       }
@@ -179,50 +269,279 @@ struct context {
       }
       return result.ref();
     };
+    details::count(details::counter::callback);
     return {*this,
             JSObjectMake(_ref, callback_class(),
                          new internal_callback_type{std::move(callback_func)})};
   }
 
+  // Fast binding for hot functions: callback receives a native_call, a
+  // non-owning view of the raw call, and may return a JSValueRef, void or any
+  // type with a convert specialization. Calls involve no wrapper, allocation
+  // or protection.
+  template <typename callback_type>
+  inline object native(callback_type callback) {
+    details::count(details::counter::callback);
+    return {*this,
+            JSObjectMake(_ref, native_class<callback_type>(),
+                         new callback_type{std::move(callback)})};
+  }
+
+  // Binds a function or callable with typed parameters, e.g.
+  //   ctx.function([](double x, const std::string& s) { return x + s.size(); })
+  // Arguments and result are converted through jsc::convert at compile time;
+  // a wrong argument count is thrown as an Error.
+  template <typename callback_type>
+  inline object function(callback_type callback) {
+    return native([callback{std::move(callback)}](
+                      const native_call& call) mutable {
+      return details::typed_call<callback_type>::invoke(callback, call);
+    });
+  }
+  template <auto callback>
+  inline object function() {
+    return native([](const native_call& call) {
+      auto function{callback};
+      return details::typed_call<decltype(callback)>::invoke(function, call);
+    });
+  }
+
+  // In error_mode::exception, calls that make the engine throw raise
+  // jsc::js_error instead of storing the exception. Either way the success
+  // path never touches the exception slot.
+  inline void set_error_mode(error_mode mode) noexcept { _error_mode = mode; }
+  [[nodiscard]] inline error_mode get_error_mode() const noexcept {
+    return _error_mode;
+  }
+
   [[nodiscard]] inline bool ok() const { return _exception.is_undefined(); }
   [[nodiscard]] inline const value& get_exception() const { return _exception; }
-  inline void clear_exception() { _exception = undefined(); }
+  // Whether the stored exception comes from a script stopped for its time
+  // limit
+  [[nodiscard]] inline bool terminated() const noexcept { return _terminated; }
+  inline void clear_exception() {
+    _exception = undefined();
+    _exception.own();
+    _terminated = false;
+  }
 
+  // Stops calls into the engine that run longer than limit on any context of
+  // this context's group, as the engine keeps one limit per context_group;
+  // zero removes it. The limit is removed as well when this context object is
+  // destroyed; its copies do not share that.
+  inline void set_time_limit(std::chrono::duration<double> limit) {
+    details::exchange_time_limit(JSContextGetGroup(_ref), limit.count());
+    _owns_time_limit = limit.count() > 0;
+  }
+
+  value eval_script(const char* script,
+                    const std::string& source_url = "<anonymous>");
   value eval_script(const std::string& script,
                     const std::string& source_url = "<anonymous>");
+  value eval_script(std::string_view script,
+                    const std::string& source_url = "<anonymous>");
+  // Takes UTF-16 code units, e.g. from jsast::utf16_sink, straight into the
+  // engine's string representation.
+  value eval_script(std::u16string_view script,
+                    const std::string& source_url = "<anonymous>");
+  value eval_script(const script& script);
+  // Evaluates a file through a read-only memory mapping rather than reading it
+  // into a string; a file that cannot be opened is reported as an exception
+  value eval_file(const std::string& path);
+
+  // Syntax check without running anything; errors are reported through
+  // get_exception()
+  bool check_syntax(const script& script);
+  // Compiles script once into a function of this context, so that each call()
+  // only executes it. The source runs as a function body: top-level
+  // declarations are local to it and results must be passed by return.
+  object compile(const script& script);
+
+  // Copies the graph of primitives, arrays, plain objects, ArrayBuffers and
+  // typed arrays reachable from val into a buffer that deserialize() rebuilds
+  // in any context, keeping shared references and cycles. Functions and
+  // symbols are reported as a DataCloneError; other objects keep only their
+  // enumerable properties.
+  [[nodiscard]] clone_buffer serialize(const value& val);
+  [[nodiscard]] value deserialize(const clone_buffer& buffer);
+  // Zero-filled ArrayBuffer whose memory serialize() shares instead of copying
+  [[nodiscard]] object shared_array_buffer(size_t size);
+
+  // Asks the collector to run soon; the engine still decides when
+  void collect_garbage();
+  // Tells the collector that JS objects keep size bytes outside its heap
+  // alive, so that it runs sooner
+  void report_external_memory(size_t size);
+  // Requests a collection every time this many bytes were reported through
+  // this wrapper since the last collect_garbage(); 0 disables it. This paces
+  // collections rather than limiting memory: bytes freed by finalizers are not
+  // taken back.
+  inline void collect_every(size_t reported_bytes) noexcept {
+    _collect_every = reported_bytes;
+  }
+  [[nodiscard]] memory_statistics memory_usage() const;
+
+  // Builds a whole value in one call to the engine's JSON parser, without
+  // creating keys or protecting values one property at a time. Invalid JSON
+  // is reported as an exception.
+  value from_json(std::string_view json);
+  value from_json(std::u16string_view json);
+  // Writes val with json_writer into a reused buffer and parses the result
+  template <typename val_type>
+  inline value from_native(const val_type& val) {
+    details::scratch_buffer<std::string> buffer;
+    json_writer{*buffer}.write(val);
+    return from_json(std::string_view{*buffer});
+  }
 
  private:
   JSGlobalContextRef _ref;
+  handle_scope* _scope{nullptr};
+  error_mode _error_mode{error_mode::store};
+  size_t _collect_every{0};
+  size_t _reported_since_collect{0};
+  bool _terminated{false};
+  bool _owns_time_limit{false};
   value _exception;
 
   inline void set_exception(value exception) {
     if (!exception.is_undefined()) {
-      _exception = exception;
+      _exception = std::move(exception);
+      _exception.own();
+      _terminated = false;
     }
   }
 
+  // The engine only writes the slot when it throws
   template <typename throwable>
   auto try_throwable(throwable t) {
-    JSValueRef exception = JSValueMakeUndefined(_ref);
+    details::count(details::counter::try_throwable);
+    const details::engine_entry entry;
+    JSValueRef exception{nullptr};
     if constexpr (std::is_same_v<decltype(t(&exception)), void>) {
       t(&exception);
-      set_exception({*this, exception});
+      if (exception != nullptr) {
+        raise(exception);
+      }
     } else {
       auto result = t(&exception);
-      set_exception({*this, exception});
-      return std::move(result);
+      if (exception != nullptr) {
+        raise(exception);
+      }
+      return result;
     }
   }
 
+  void raise(JSValueRef exception);
+
+  // The engine's parser reports no details, so failures become a plain Error
+  value from_json_string(const details::string_wrapper& json);
+
+  // Returns whether the caller is responsible for unprotecting val
+  [[nodiscard]] inline bool root(JSValueRef val) const {
+    if (_scope != nullptr) {
+      _scope->add(val);
+      return false;
+    }
+    protect(val);
+    return true;
+  }
+
   inline void protect(JSValueRef val) const {
+    details::count(details::counter::protect);
     JSGlobalContextRetain(_ref);
     JSValueProtect(_ref, val);
   }
   inline void unprotect(JSValueRef val) const {
+    details::count(details::counter::unprotect);
     JSValueUnprotect(_ref, val);
     JSGlobalContextRelease(_ref);
   }
 
+ public:
+  // Exposes bytes as an ArrayBuffer without copying. The memory must stay valid
+  // until deallocator (if any) is called by the garbage collector.
+  [[nodiscard]] inline object array_buffer(
+      void* bytes, size_t length,
+      JSTypedArrayBytesDeallocator deallocator = nullptr,
+      void* deallocator_context = nullptr) {
+    return {*this, try_throwable([&](auto exception) {
+              return JSObjectMakeArrayBufferWithBytesNoCopy(
+                  _ref, bytes, length, deallocator, deallocator_context,
+                  exception);
+            })};
+  }
+
+  // Typed array over count elements at data, without copying
+  template <typename elem_type>
+  [[nodiscard]] inline object typed_array(
+      elem_type* data, size_t count,
+      JSTypedArrayBytesDeallocator deallocator = nullptr,
+      void* deallocator_context = nullptr) {
+    return {*this, try_throwable([&](auto exception) {
+              return JSObjectMakeTypedArrayWithBytesNoCopy(
+                  _ref, typed_array_type_for<elem_type>, data,
+                  count * sizeof(elem_type), deallocator, deallocator_context,
+                  exception);
+            })};
+  }
+
+  // Typed array that takes ownership of data and frees it once collected
+  template <typename elem_type>
+  [[nodiscard]] inline object typed_array(std::vector<elem_type> data) {
+    // Released only once the engine holds it, as raise() may throw
+    auto owned{std::make_unique<std::vector<elem_type>>(std::move(data))};
+    return {*this, try_throwable([&](auto exception) {
+              const auto result{JSObjectMakeTypedArrayWithBytesNoCopy(
+                  _ref, typed_array_type_for<elem_type>, owned->data(),
+                  owned->size() * sizeof(elem_type),
+                  [](void*, void* vector) {
+                    delete static_cast<std::vector<elem_type>*>(vector);
+                  },
+                  owned.get(), exception)};
+              if (result != nullptr) {
+                owned.release();
+              }
+              return result;
+            })};
+  }
+
+  // Zero-filled typed array owned by the engine
+  template <typename elem_type>
+  [[nodiscard]] inline object typed_array(size_t count) {
+    return {*this, try_throwable([&](auto exception) {
+              return JSObjectMakeTypedArray(
+                  _ref, typed_array_type_for<elem_type>, count, exception);
+            })};
+  }
+
+  // Builds a JS array from any container in one call, see
+  // details::make_array; wrappers are buffered like immediates
+  template <typename container_type>
+  [[nodiscard]] inline object array(const container_type& elems) {
+    using elem_type = typename container_type::value_type;
+    constexpr auto buffered{converts_to_immediate<elem_type> ||
+                            std::is_same_v<elem_type, value> ||
+                            std::is_same_v<elem_type, object>};
+    return {*this, try_throwable([this, &elems](auto exception) {
+              return details::make_array<buffered>(
+                  _ref, elems,
+                  [this](const elem_type& elem) { return raw(elem); },
+                  exception);
+            })};
+  }
+
+ private:
+  template <typename elem_type>
+  [[nodiscard]] inline JSValueRef raw(const elem_type& elem) const {
+    if constexpr (std::is_same_v<elem_type, value> ||
+                  std::is_same_v<elem_type, object>) {
+      return elem.ref();
+    } else {
+      return convert<elem_type>::to(_ref, elem);
+    }
+  }
+
  public:
   [[nodiscard]] inline object error(const std::string& message) {
     // TODO: Add error subclassing
@@ -0,0 +1,96 @@
+#ifndef jsc_context_pool_hpp
+#define jsc_context_pool_hpp
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "context.hpp"
+
+namespace jsc {
+
+// Fixed set of contexts that are created and bootstrapped up front and lent
+// to worker threads one at a time. acquire() waits while all are in use.
+struct context_pool {
+  enum class reset_policy {
+    // Only clears the pending exception; globals persist between leases
+    clear_exception,
+    // Runs the bootstrap script again on return
+    rerun_bootstrap,
+    // Replaces the context with a freshly bootstrapped one on return
+    recreate
+  };
+
+  struct options {
+    size_t size{4};
+    std::string bootstrap;
+    std::string bootstrap_url{"<bootstrap>"};
+    reset_policy reset{reset_policy::clear_exception};
+    // Contexts in one group can exchange values, but the group's VM lock
+    // serializes them, so parallel execution needs separate groups.
+    bool shared_group{false};
+  };
+
+  struct lease {
+    friend context_pool;
+
+    inline lease(lease&& other) noexcept
+        : _pool{other._pool}, _ctx{std::move(other._ctx)} {}
+    inline lease& operator=(lease&& other) noexcept {
+      release();
+      _pool = other._pool;
+      _ctx = std::move(other._ctx);
+      return *this;
+    }
+    inline ~lease() { release(); }
+
+    [[nodiscard]] inline context& operator*() const { return *_ctx; }
+    [[nodiscard]] inline context* operator->() const { return _ctx.get(); }
+
+   private:
+    context_pool* _pool;
+    std::unique_ptr<context> _ctx;
+
+    inline lease(context_pool& pool, std::unique_ptr<context> ctx)
+        : _pool{&pool}, _ctx{std::move(ctx)} {}
+
+    inline void release() {
+      if (_ctx) {
+        _pool->release(std::move(_ctx));
+      }
+    }
+  };
+
+  // Throws std::runtime_error if the bootstrap script throws.
+  explicit context_pool(options opts);
+
+  context_pool(const context_pool&) = delete;
+  context_pool& operator=(const context_pool&) = delete;
+
+  [[nodiscard]] lease acquire();
+  [[nodiscard]] std::optional<lease> try_acquire(
+      std::chrono::milliseconds timeout);
+
+  [[nodiscard]] size_t available() const;
+  [[nodiscard]] inline size_t size() const noexcept { return _options.size; }
+
+ private:
+  options _options;
+  std::optional<context_group> _group;
+  mutable std::mutex _mutex;
+  std::condition_variable _released;
+  std::vector<std::unique_ptr<context>> _idle;
+
+  [[nodiscard]] std::unique_ptr<context> make_context();
+  bool bootstrap(context& ctx);
+  void release(std::unique_ptr<context> ctx);
+  [[nodiscard]] lease take(std::unique_lock<std::mutex>& lock);
+};
+
+}  // namespace jsc
+
+#endif  // jsc_context_pool_hpp
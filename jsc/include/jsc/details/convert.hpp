@@ -0,0 +1,362 @@
+#ifndef jsc_convert_hpp
+#define jsc_convert_hpp
+
+#include <JavaScriptCore/JavaScriptCore.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "fields.hpp"
+#include "key.hpp"
+#include "string.hpp"
+
+namespace jsc {
+
+// Conversion between C++ values and raw engine values, without wrappers.
+// Specializations provide
+//   static JSValueRef to(JSContextRef, const type&);
+//   static type from(JSContextRef, JSValueRef, JSValueRef* exception);
+template <typename type, typename = void>
+struct convert;
+
+template <>
+struct convert<bool> {
+  [[nodiscard]] static inline JSValueRef to(JSContextRef ctx, bool b) {
+    return JSValueMakeBoolean(ctx, b);
+  }
+  [[nodiscard]] static inline bool from(JSContextRef ctx, JSValueRef val,
+                                        JSValueRef*) {
+    return JSValueToBoolean(ctx, val);
+  }
+};
+
+namespace details {
+
+// JS numbers may be NaN, infinite or out of range for the target type, which
+// a plain cast does not allow. Integers saturate and read NaN as 0; floats
+// that overflow become infinite.
+template <typename number_type>
+[[nodiscard]] inline number_type number_cast(double num) {
+  using limits = std::numeric_limits<number_type>;
+  if constexpr (std::is_integral_v<number_type>) {
+    if (std::isnan(num)) {
+      return 0;
+    }
+    if (num <= static_cast<double>(limits::min())) {
+      return limits::min();
+    }
+    if (num >= static_cast<double>(limits::max())) {
+      return limits::max();
+    }
+  } else if (std::isfinite(num) &&
+             std::abs(num) > static_cast<double>(limits::max())) {
+    return num < 0 ? -limits::infinity() : limits::infinity();
+  }
+  return static_cast<number_type>(num);
+}
+
+}  // namespace details
+
+template <typename number_type>
+struct convert<number_type,
+               std::enable_if_t<std::is_arithmetic_v<number_type>>> {
+  [[nodiscard]] static inline JSValueRef to(JSContextRef ctx,
+                                            number_type num) {
+    return JSValueMakeNumber(ctx, static_cast<double>(num));
+  }
+  [[nodiscard]] static inline number_type from(JSContextRef ctx,
+                                               JSValueRef val,
+                                               JSValueRef* exception) {
+    return details::number_cast<number_type>(
+        JSValueToNumber(ctx, val, exception));
+  }
+};
+
+template <>
+struct convert<std::string> {
+  [[nodiscard]] static inline JSValueRef to(JSContextRef ctx,
+                                            const std::string& str) {
+    return JSValueMakeString(ctx, details::string_wrapper{str}.managed_ref());
+  }
+  [[nodiscard]] static inline std::string from(JSContextRef ctx,
+                                               JSValueRef val,
+                                               JSValueRef* exception) {
+    const auto js_string{JSValueToStringCopy(ctx, val, exception)};
+    if (js_string == nullptr) {
+      return {};
+    }
+    return details::string_wrapper{js_string}.get();
+  }
+};
+
+template <>
+struct convert<const char*> {
+  [[nodiscard]] static inline JSValueRef to(JSContextRef ctx,
+                                            const char* str) {
+    return JSValueMakeString(ctx, details::string_wrapper{str}.managed_ref());
+  }
+};
+
+// Immediates never allocate on the garbage-collected heap, so raw refs to them
+// may be buffered without protection.
+template <typename type>
+static constexpr bool converts_to_immediate{std::is_arithmetic_v<type>};
+
+template <typename type, typename = void>
+struct has_convert : std::false_type {};
+template <typename type>
+struct has_convert<type, std::void_t<decltype(convert<type>::to(
+                             std::declval<JSContextRef>(),
+                             std::declval<const type&>()))>>
+    : std::true_type {};
+
+// Empty optionals are undefined; undefined and null read back as empty
+template <typename elem_type>
+struct convert<std::optional<elem_type>> {
+  [[nodiscard]] static inline JSValueRef to(
+      JSContextRef ctx, const std::optional<elem_type>& opt) {
+    return opt.has_value() ? convert<elem_type>::to(ctx, *opt)
+                           : JSValueMakeUndefined(ctx);
+  }
+  [[nodiscard]] static inline std::optional<elem_type> from(
+      JSContextRef ctx, JSValueRef val, JSValueRef* exception) {
+    if (JSValueIsUndefined(ctx, val) || JSValueIsNull(ctx, val)) {
+      return std::nullopt;
+    }
+    return convert<elem_type>::from(ctx, val, exception);
+  }
+};
+
+namespace details {
+
+// Builds an array from elems, to_raw giving the engine value of each element.
+// When buffered, i.e. the values are immediates or held by wrappers, they are
+// passed to JSObjectMakeArray as one buffer; otherwise each is stored as it is
+// created, as a buffered unprotected heap value could be collected by a later
+// allocation.
+template <bool buffered, typename container_type, typename raw_type>
+[[nodiscard]] inline JSObjectRef make_array(JSContextRef ctx,
+                                            const container_type& elems,
+                                            raw_type to_raw,
+                                            JSValueRef* exception) {
+  if constexpr (buffered) {
+    std::vector<JSValueRef> refs;
+    refs.reserve(std::size(elems));
+    for (const auto& elem : elems) {
+      refs.push_back(to_raw(elem));
+    }
+    return JSObjectMakeArray(ctx, refs.size(), refs.data(), exception);
+  } else {
+    const auto result{JSObjectMakeArray(ctx, 0, nullptr, exception)};
+    if (result == nullptr) {
+      return nullptr;
+    }
+    unsigned int index{0};
+    for (const auto& elem : elems) {
+      JSObjectSetPropertyAtIndex(ctx, result, index++, to_raw(elem), nullptr);
+    }
+    return result;
+  }
+}
+
+// Lengths up to this are read as is. Longer ones must be backed by as many
+// elements, so that e.g. ({length: 4e9}) is an error rather than billions of
+// reads; only this much is reserved up front.
+constexpr unsigned int trusted_array_length{1 << 16};
+
+[[nodiscard]] inline bool has_elements(JSContextRef ctx, JSObjectRef obj,
+                                       unsigned int length) {
+  if (JSValueGetTypedArrayType(ctx, obj, nullptr) != kJSTypedArrayTypeNone) {
+    return true;
+  }
+  const auto names{JSObjectCopyPropertyNames(ctx, obj)};
+  const auto count{JSPropertyNameArrayGetCount(names)};
+  JSPropertyNameArrayRelease(names);
+  return count >= length;
+}
+
+// Reads an array-like object into out with a single length lookup, read
+// converting each element; stops at the first exception
+template <typename elem_type, typename read_type>
+inline void read_array(JSContextRef ctx, JSObjectRef obj,
+                       std::vector<elem_type>& out, JSValueRef* exception,
+                       read_type read) {
+  out.clear();
+  const auto initial{*exception};
+  const auto length_ref{JSObjectGetProperty(
+      ctx, obj, JSC_KEY("length").managed_ref(), exception)};
+  if (*exception != initial) {
+    return;
+  }
+  const auto length{
+      number_cast<unsigned int>(JSValueToNumber(ctx, length_ref, exception))};
+  if (*exception != initial) {
+    return;
+  }
+  if (length > trusted_array_length && !has_elements(ctx, obj, length)) {
+    const auto message{JSValueMakeString(
+        ctx, string_wrapper{"Array is too sparse to convert"}.managed_ref())};
+    *exception = JSObjectMakeError(ctx, 1, &message, nullptr);
+    return;
+  }
+  out.reserve(std::min(length, trusted_array_length));
+  for (unsigned int i{0}; i < length && *exception == initial; i++) {
+    const auto elem{JSObjectGetPropertyAtIndex(ctx, obj, i, exception)};
+    if (*exception != initial) {
+      break;
+    }
+    auto converted{read(elem)};
+    if (*exception != initial) {
+      break;
+    }
+    out.push_back(std::move(converted));
+  }
+}
+
+}  // namespace details
+
+template <typename elem_type>
+struct convert<std::vector<elem_type>> {
+  [[nodiscard]] static inline JSValueRef to(
+      JSContextRef ctx, const std::vector<elem_type>& elems) {
+    return details::make_array<converts_to_immediate<elem_type>>(
+        ctx, elems,
+        [ctx](const elem_type& elem) {
+          return convert<elem_type>::to(ctx, elem);
+        },
+        nullptr);
+  }
+  [[nodiscard]] static inline std::vector<elem_type> from(
+      JSContextRef ctx, JSValueRef val, JSValueRef* exception) {
+    std::vector<elem_type> result;
+    const auto obj{JSValueToObject(ctx, val, exception)};
+    if (obj != nullptr) {
+      details::read_array(ctx, obj, result, exception,
+                          [ctx, exception](JSValueRef elem) {
+                            return convert<elem_type>::from(ctx, elem,
+                                                            exception);
+                          });
+    }
+    return result;
+  }
+};
+
+namespace details {
+
+// Objects keyed by string, for std::map and std::unordered_map
+template <typename map_type>
+struct convert_map {
+  using mapped_type = typename map_type::mapped_type;
+
+  [[nodiscard]] static inline JSValueRef to(JSContextRef ctx,
+                                            const map_type& map) {
+    const auto result{JSObjectMake(ctx, nullptr, nullptr)};
+    for (const auto& [name, val] : map) {
+      JSObjectSetProperty(ctx, result, string_wrapper{name}.managed_ref(),
+                          convert<mapped_type>::to(ctx, val),
+                          kJSPropertyAttributeNone, nullptr);
+    }
+    return result;
+  }
+  [[nodiscard]] static inline map_type from(JSContextRef ctx, JSValueRef val,
+                                            JSValueRef* exception) {
+    map_type result;
+    const auto obj{JSValueToObject(ctx, val, exception)};
+    if (obj == nullptr) {
+      return result;
+    }
+    const auto names{JSObjectCopyPropertyNames(ctx, obj)};
+    const auto count{JSPropertyNameArrayGetCount(names)};
+    for (size_t i{0}; i < count && *exception == nullptr; i++) {
+      const auto name{JSPropertyNameArrayGetNameAtIndex(names, i)};
+      const auto prop{JSObjectGetProperty(ctx, obj, name, exception)};
+      if (*exception != nullptr) {
+        break;
+      }
+      auto mapped{convert<mapped_type>::from(ctx, prop, exception)};
+      if (*exception == nullptr) {
+        JSStringRetain(name);
+        result.emplace(string_wrapper{name}.get(), std::move(mapped));
+      }
+    }
+    JSPropertyNameArrayRelease(names);
+    return result;
+  }
+};
+
+// One key per field, created on first use and shared by every conversion
+template <typename record_type, size_t... index>
+[[nodiscard]] inline const std::array<key, sizeof...(index)>& field_keys(
+    std::index_sequence<index...>) {
+  static const std::array<key, sizeof...(index)> keys{
+      key{std::get<index>(fields<record_type>::list).name}...};
+  return keys;
+}
+template <typename record_type>
+[[nodiscard]] inline const auto& field_keys() {
+  return field_keys<record_type>(
+      std::make_index_sequence<field_count<record_type>>{});
+}
+
+}  // namespace details
+
+template <typename mapped_type>
+struct convert<std::map<std::string, mapped_type>>
+    : details::convert_map<std::map<std::string, mapped_type>> {};
+template <typename mapped_type>
+struct convert<std::unordered_map<std::string, mapped_type>>
+    : details::convert_map<std::unordered_map<std::string, mapped_type>> {};
+
+// Structs with declared jsc::fields become plain objects with the fields set
+// in declaration order, and are read back field by field; the struct must be
+// default constructible.
+template <typename record_type>
+struct convert<record_type, std::enable_if_t<has_fields<record_type>::value>> {
+  [[nodiscard]] static inline JSValueRef to(JSContextRef ctx,
+                                            const record_type& record) {
+    const auto& keys{details::field_keys<record_type>()};
+    const auto result{JSObjectMake(ctx, nullptr, nullptr)};
+    details::for_each_field<record_type>([&](size_t index, const auto& info) {
+      using member_type = typename std::decay_t<decltype(info)>::value_type;
+      JSObjectSetProperty(ctx, result, keys[index].managed_ref(),
+                          convert<member_type>::to(ctx, record.*info.member),
+                          kJSPropertyAttributeNone, nullptr);
+    });
+    return result;
+  }
+  [[nodiscard]] static inline record_type from(JSContextRef ctx,
+                                               JSValueRef val,
+                                               JSValueRef* exception) {
+    record_type result{};
+    const auto obj{JSValueToObject(ctx, val, exception)};
+    if (obj == nullptr) {
+      return result;
+    }
+    const auto& keys{details::field_keys<record_type>()};
+    details::for_each_field<record_type>([&](size_t index, const auto& info) {
+      using member_type = typename std::decay_t<decltype(info)>::value_type;
+      if (*exception != nullptr) {
+        return;
+      }
+      const auto prop{JSObjectGetProperty(ctx, obj, keys[index].managed_ref(),
+                                          exception)};
+      if (*exception == nullptr) {
+        result.*info.member = convert<member_type>::from(ctx, prop, exception);
+      }
+    });
+    return result;
+  }
+};
+
+}  // namespace jsc
+
+#endif  // jsc_convert_hpp
@@ -0,0 +1,211 @@
+#ifndef jsc_coroutine_hpp
+#define jsc_coroutine_hpp
+
+#include "task.hpp"
+
+#ifdef JSC_HAS_COROUTINES
+
+#include <JavaScriptCore/JavaScriptCore.h>
+#include <memory>
+#include <type_traits>
+
+#include "convert.hpp"
+#include "error.hpp"
+#include "event_loop.hpp"
+#include "key.hpp"
+#include "native.hpp"
+#include "object.hpp"
+#include "value.hpp"
+
+namespace jsc {
+
+namespace details {
+
+struct coroutine_bridge {
+  struct resolve_awaiter {
+    inline resolve_awaiter(event_loop& loop, JSValueRef val)
+        : _loop{loop},
+          _state{std::make_shared<state>(value{loop._ctx, val})} {}
+    // A task destroyed while suspended here must not be resumed by a
+    // promise that settles later
+    inline ~resolve_awaiter() {
+      if (_state != nullptr) {
+        _state->cancelled = true;
+      }
+    }
+
+    resolve_awaiter(resolve_awaiter&&) = default;
+    resolve_awaiter& operator=(resolve_awaiter&&) = delete;
+
+    // Non-thenables and getters that throw settle without suspending
+    [[nodiscard]] inline bool await_ready() {
+      const auto ctx{_loop.ref()};
+      if (!JSValueIsObject(ctx, _state->result.ref())) {
+        return true;
+      }
+      _target = JSValueToObject(ctx, _state->result.ref(), nullptr);
+      JSValueRef exception{nullptr};
+      const auto then{JSObjectGetProperty(
+          ctx, _target, JSC_KEY("then").managed_ref(), &exception)};
+      if (exception != nullptr) {
+        _state->settle(exception, true);
+        return true;
+      }
+      if (!JSValueIsObject(ctx, then) ||
+          !JSObjectIsFunction(ctx, const_cast<JSObjectRef>(then))) {
+        return true;
+      }
+      _then = const_cast<JSObjectRef>(then);
+      return false;
+    }
+
+    // The reactions may run inside then() for non-standard thenables, which
+    // resumes and possibly destroys the awaiting frame, so only locals are
+    // used once then() has been called.
+    inline bool await_suspend(std::coroutine_handle<> handle) {
+      const auto ctx{_loop.ref()};
+      const auto settled{_state};
+      settled->handle = handle;
+      const auto reaction{[](std::shared_ptr<state> s, bool rejected) {
+        return [s{std::move(s)}, rejected](const native_call& call) {
+          if (!s->settled && !s->cancelled) {
+            s->settle(call.arg(0), rejected);
+            s->handle.resume();
+          }
+        };
+      }};
+      const auto on_fulfilled{_loop._ctx.native(reaction(settled, false))};
+      const auto on_rejected{_loop._ctx.native(reaction(settled, true))};
+      const JSValueRef reactions[]{on_fulfilled.ref(), on_rejected.ref()};
+      JSValueRef exception{nullptr};
+      JSObjectCallAsFunction(ctx, _then, _target, 2, reactions, &exception);
+      if (exception != nullptr && !settled->settled) {
+        settled->settle(exception, true);
+        return false;
+      }
+      return true;
+    }
+
+    [[nodiscard]] inline value await_resume() const {
+      const auto& result{_state->result};
+      if (_state->rejected) {
+        throw js_error{result, result.to_string()};
+      }
+      return result;
+    }
+
+   private:
+    // Shared with the reaction functions, which the collector may keep alive
+    // after the coroutine is gone. The result is protected, as nothing else
+    // roots it between settling and resumption.
+    struct state {
+      inline explicit state(value initial) : result{std::move(initial)} {
+        result.own();
+      }
+
+      inline void settle(JSValueRef val, bool is_rejected) {
+        settled = true;
+        result = value{*result._ctx, val};
+        result.own();
+        rejected = is_rejected;
+      }
+
+      std::coroutine_handle<> handle;
+      value result;
+      bool rejected{false};
+      bool settled{false};
+      // Set once the awaiting frame is gone
+      bool cancelled{false};
+    };
+
+    event_loop& _loop;
+    std::shared_ptr<state> _state;
+    JSObjectRef _target{nullptr};
+    JSObjectRef _then{nullptr};
+  };
+
+  template <typename result_type>
+  [[nodiscard]] static inline object start(event_loop& loop,
+                                           task<result_type> t) {
+    unsigned int id{0};
+    auto promise{loop.deferred_promise(id)};
+    if (id != 0) {
+      drive(loop, std::move(t), id);
+    }
+    return promise;
+  }
+
+ private:
+  // Resolving and rejecting functions never throw, so neither can this
+  template <typename result_type>
+  static detached drive(event_loop& loop, task<result_type> t,
+                        unsigned int id) {
+    try {
+      if constexpr (std::is_same_v<result_type, void>) {
+        co_await std::move(t);
+        loop.settle(id, JSValueMakeUndefined(loop.ref()), false);
+      } else if constexpr (std::is_same_v<result_type, value> ||
+                           std::is_same_v<result_type, object>) {
+        const auto result{co_await std::move(t)};
+        loop.settle(id, result.ref(), false);
+      } else {
+        const auto result{co_await std::move(t)};
+        loop.settle(id, convert<result_type>::to(loop.ref(), result), false);
+      }
+    } catch (const js_error& error) {
+      loop.settle(id, error.exception().ref(), true);
+    } catch (const std::exception& error) {
+      loop.reject_with(id, error.what());
+    }
+  }
+};
+
+}  // namespace details
+
+// Awaits val the way `await` does in an async function: promises and other
+// thenables are waited for, anything else is the result right away. A
+// rejection is thrown as jsc::js_error. The coroutine resumes inside the
+// promise reaction, so on the thread running the loop, e.g.
+//   jsc::task<double> total(jsc::event_loop& loop, jsc::object fetch) {
+//     const auto a{co_await jsc::resolve(loop, fetch.call("a"))};
+//     const auto b{co_await jsc::resolve(loop, fetch.call("b"))};
+//     co_return a.to_number() + b.to_number();
+//   }
+[[nodiscard]] inline details::coroutine_bridge::resolve_awaiter resolve(
+    event_loop& loop, const value& val) {
+  return {loop, val.ref()};
+}
+
+// Moves the awaiting coroutine onto the loop thread, e.g. after it was resumed
+// by a thread of its own. run() does not wait for a post that has not been
+// made yet.
+[[nodiscard]] inline auto resume_on(event_loop& loop) {
+  struct awaiter {
+    event_loop& loop;
+
+    [[nodiscard]] inline bool await_ready() const noexcept { return false; }
+    inline void await_suspend(std::coroutine_handle<> handle) const {
+      loop.post([handle](context&) { handle.resume(); });
+    }
+    inline void await_resume() const noexcept {}
+  };
+  return awaiter{loop};
+}
+
+// Starts t and returns a JS promise for its result, converted through
+// jsc::convert. The loop stays alive until t completes; a thrown js_error
+// rejects with its JS value, other exceptions with an Error. Native functions
+// can return it to make JS-callable coroutines:
+//   ctx.native([&](const native_call& call) {
+//     return jsc::start(loop, total(loop, call.get<...>(0))).ref();
+//   })
+template <typename result_type>
+[[nodiscard]] inline object start(event_loop& loop, task<result_type> t) {
+  return details::coroutine_bridge::start(loop, std::move(t));
+}
+
+}  // namespace jsc
+
+#endif  // JSC_HAS_COROUTINES
+
+#endif  // jsc_coroutine_hpp
@@ -0,0 +1,78 @@
+#ifndef jsc_error_hpp
+#define jsc_error_hpp
+
+#include <JavaScriptCore/JavaScriptCore.h>
+#include <stdexcept>
+#include <string>
+
+#include "convert.hpp"
+#include "time_limit.hpp"
+#include "value.hpp"
+
+namespace jsc {
+
+// How a context reports exceptions thrown by the engine
+enum class error_mode {
+  // Kept for ok() and get_exception() until clear_exception()
+  store,
+  // Thrown as jsc::js_error from the failing call
+  exception
+};
+
+// A JS exception surfaced as a C++ exception
+struct js_error : std::runtime_error {
+  inline js_error(value exception, const std::string& message)
+      : std::runtime_error{message}, _exception{std::move(exception)} {}
+
+  [[nodiscard]] inline const value& exception() const noexcept {
+    return _exception;
+  }
+
+ private:
+  value _exception;
+};
+
+// Thrown instead of js_error when the engine stops a script for exceeding its
+// time_limit. Scripts cannot catch the termination, and the context can be
+// used again once it is reported.
+struct execution_terminated : js_error {
+  using js_error::js_error;
+};
+
+namespace details {
+
+// Runs the body of a C callback from the engine, turning C++ exceptions into
+// JS ones; they must not unwind through the engine's frames.
+template <typename result_type, typename callable_type>
+[[nodiscard]] inline result_type guard_callback(JSContextRef ctx,
+                                                JSValueRef* exception,
+                                                result_type fallback,
+                                                callable_type callable) {
+  try {
+    auto result{callable()};
+    // A call stopped for its time limit stops the calling script too, even if
+    // store mode kept the termination in a context instead of throwing it
+    if (termination_pending && *exception == nullptr &&
+        termination_exception != nullptr) {
+      *exception = termination_exception;
+      return fallback;
+    }
+    return result;
+  } catch (const js_error& error) {
+    *exception = error.exception().ref();
+  } catch (const std::exception& error) {
+    const auto message{convert<const char*>::to(ctx, error.what())};
+    *exception = JSObjectMakeError(ctx, 1, &message, nullptr);
+  } catch (...) {
+    const auto message{
+        convert<const char*>::to(ctx, "Unknown native exception")};
+    *exception = JSObjectMakeError(ctx, 1, &message, nullptr);
+  }
+  return fallback;
+}
+
+}  // namespace details
+
+}  // namespace jsc
+
+#endif  // jsc_error_hpp
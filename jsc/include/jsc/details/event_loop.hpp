@@ -0,0 +1,173 @@
+#ifndef jsc_event_loop_hpp
+#define jsc_event_loop_hpp
+
+#include <JavaScriptCore/JavaScriptCore.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "context.hpp"
+#include "convert.hpp"
+#include "mpsc_queue.hpp"
+#include "object.hpp"
+
+namespace jsc {
+
+namespace details {
+struct coroutine_bridge;
+}  // namespace details
+
+// Runs the asynchronous part of scripts on a context: timers, tasks posted
+// from other threads and promises settled by background work. The context
+// must only be used from the thread calling run(), and must outlive the loop.
+//
+// The engine drains the microtask queue whenever a call into it returns, so
+// promise reactions queued by a script, timer or task run before the loop
+// moves on to the next one.
+struct event_loop {
+  using task = std::function<void(context&)>;
+
+  // Installs setTimeout, setInterval, clearTimeout and clearInterval on the
+  // global object; they are removed again when the loop is destroyed. Work
+  // passed to defer() runs on up to workers threads, started on first use.
+  explicit event_loop(context& ctx, size_t workers = 2);
+  ~event_loop();
+
+  event_loop(const event_loop&) = delete;
+  event_loop& operator=(const event_loop&) = delete;
+
+  // Safe from any thread: queues t to run on the loop thread
+  void post(task t);
+
+  // Promise for the result of work, which runs on a worker thread. The result
+  // is converted through jsc::convert on the loop thread; a std::exception
+  // thrown by work rejects the promise with an Error. Native functions can
+  // return it directly, e.g.
+  //   ctx.native([&loop](const native_call& call) {
+  //     return loop.defer([path{call.get<std::string>(0)}] { ... }).ref();
+  //   })
+  template <typename work_type>
+  object defer(work_type work);
+
+  // Runs until no timers, deferred work or queued tasks are left, or until
+  // stop() is called. Exceptions from callbacks are stored on the context in
+  // error_mode::store, and propagate out of run() in error_mode::exception.
+  void run();
+  // Runs the tasks and timers that are ready without waiting. Returns whether
+  // anything is still pending.
+  bool run_once();
+  // Safe from any thread
+  void stop();
+
+  [[nodiscard]] bool alive() const;
+
+ private:
+  friend details::coroutine_bridge;
+
+  using clock = std::chrono::steady_clock;
+
+  struct timer {
+    JSObjectRef function;
+    std::vector<JSValueRef> args;
+    clock::duration interval;
+    bool repeat;
+  };
+
+  struct scheduled {
+    clock::time_point due;
+    unsigned int id;
+
+    [[nodiscard]] inline bool operator>(const scheduled& other) const {
+      return due != other.due ? due > other.due : id > other.id;
+    }
+  };
+
+  struct deferred {
+    JSObjectRef resolve;
+    JSObjectRef reject;
+  };
+
+  context& _ctx;
+
+  // Loop thread only
+  std::unordered_map<unsigned int, timer> _timers;
+  std::priority_queue<scheduled, std::vector<scheduled>, std::greater<>>
+      _schedule;
+  std::unordered_map<unsigned int, deferred> _deferred;
+  std::deque<task> _ready;
+  unsigned int _next_id{1};
+
+  details::mpsc_queue<task> _posted;
+  std::atomic<bool> _stopped{false};
+  std::mutex _wake_mutex;
+  std::condition_variable _wake;
+
+  size_t _max_workers;
+  std::vector<std::thread> _workers;
+  std::mutex _work_mutex;
+  std::condition_variable _work_ready;
+  std::deque<std::function<void()>> _work;
+  bool _shutting_down{false};
+
+  unsigned int add_timer(const native_call& call, bool repeat);
+  void clear_timer(unsigned int id);
+  void release(const timer& t);
+  void run_timers();
+  void wait();
+
+  // Pending promise settled through id; on failure the object is null and
+  // the exception is reported by the context
+  [[nodiscard]] object deferred_promise(unsigned int& id);
+  void settle(unsigned int id, JSValueRef result, bool rejected);
+  void reject_with(unsigned int id, const std::string& message);
+
+  void call(JSObjectRef function, const JSValueRef* args, size_t count);
+  void submit(std::function<void()> work);
+  void work_on();
+
+  [[nodiscard]] inline JSGlobalContextRef ref() const { return _ctx._ref; }
+};
+
+template <typename work_type>
+object event_loop::defer(work_type work) {
+  unsigned int id{0};
+  auto promise{deferred_promise(id)};
+  if (id == 0) {
+    return promise;
+  }
+  submit([this, id, work{std::move(work)}]() mutable {
+    using result_type = std::decay_t<std::invoke_result_t<work_type&>>;
+    try {
+      if constexpr (std::is_same_v<result_type, void>) {
+        work();
+        post([this, id](context& ctx) {
+          settle(id, JSValueMakeUndefined(ctx._ref), false);
+        });
+      } else {
+        post([this, id, result{work()}](context& ctx) {
+          settle(id, convert<result_type>::to(ctx._ref, result), false);
+        });
+      }
+    } catch (const std::exception& error) {
+      post([this, id, message{std::string{error.what()}}](context&) {
+        reject_with(id, message);
+      });
+    }
+  });
+  return promise;
+}
+
+}  // namespace jsc
+
+#endif  // jsc_event_loop_hpp
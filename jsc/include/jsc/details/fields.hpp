@@ -0,0 +1,64 @@
+#ifndef jsc_fields_hpp
+#define jsc_fields_hpp
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace jsc {
+
+template <typename owner_type, typename member_type>
+struct field_info {
+  using value_type = member_type;
+
+  const char* name;
+  member_type owner_type::*member;
+};
+
+template <typename owner_type, typename member_type>
+[[nodiscard]] constexpr field_info<owner_type, member_type> field(
+    const char* name, member_type owner_type::*member) {
+  return {name, member};
+}
+
+// Declares the fields of a struct once, for jsc::convert and json_writer:
+//   template <>
+//   struct jsc::fields<point> {
+//     static constexpr auto list{
+//         std::make_tuple(jsc::field("x", &point::x),
+//                         jsc::field("y", &point::y))};
+//   };
+// Objects are always given the fields in this order, so every object made
+// from the struct has the same shape.
+template <typename record_type>
+struct fields;
+
+template <typename type, typename = void>
+struct has_fields : std::false_type {};
+template <typename type>
+struct has_fields<type, std::void_t<decltype(fields<type>::list)>>
+    : std::true_type {};
+
+namespace details {
+
+template <typename record_type>
+static constexpr size_t field_count{
+    std::tuple_size_v<std::decay_t<decltype(fields<record_type>::list)>>};
+
+// Calls callback(index, field) for each field, in declaration order
+template <typename record_type, typename callback_type>
+inline void for_each_field(callback_type&& callback) {
+  std::apply(
+      [&callback](const auto&... info) {
+        size_t index{0};
+        (callback(index++, info), ...);
+      },
+      fields<record_type>::list);
+}
+
+}  // namespace details
+
+}  // namespace jsc
+
+#endif  // jsc_fields_hpp
@@ -0,0 +1,84 @@
+#ifndef jsc_function_hpp
+#define jsc_function_hpp
+
+#include <functional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "convert.hpp"
+#include "native.hpp"
+
+namespace jsc::details {
+
+template <typename function_type>
+struct function_traits
+    : function_traits<decltype(&function_type::operator())> {};
+
+template <typename result, typename... arg_type>
+struct function_traits<result (*)(arg_type...)> {
+  using result_type = result;
+  using args_type = std::tuple<std::decay_t<arg_type>...>;
+  static constexpr size_t arity{sizeof...(arg_type)};
+};
+template <typename result, typename... arg_type>
+struct function_traits<result(arg_type...)>
+    : function_traits<result (*)(arg_type...)> {};
+template <typename owner_type, typename result, typename... arg_type>
+struct function_traits<result (owner_type::*)(arg_type...)>
+    : function_traits<result (*)(arg_type...)> {};
+template <typename owner_type, typename result, typename... arg_type>
+struct function_traits<result (owner_type::*)(arg_type...) const>
+    : function_traits<result (*)(arg_type...)> {};
+
+// Converts the raw arguments to the parameter types of function, calls it and
+// converts the result back, reporting arity and conversion errors to JS.
+// Leading bound arguments, such as the object for a member function pointer,
+// are passed through before the converted ones.
+template <typename function_type>
+struct typed_call {
+  using traits = function_traits<std::remove_pointer_t<function_type>>;
+  using result_type = typename traits::result_type;
+  using args_type = typename traits::args_type;
+
+  template <typename... bound_type>
+  [[nodiscard]] static inline JSValueRef invoke(function_type& function,
+                                                const native_call& call,
+                                                bound_type&&... bound) {
+    if (call.size() != traits::arity) {
+      call.throw_error("Expected " + std::to_string(traits::arity) +
+                       " argument(s), got " + std::to_string(call.size()));
+      return call.undefined();
+    }
+    return invoke_with(function, call,
+                       std::make_index_sequence<traits::arity>{},
+                       std::forward<bound_type>(bound)...);
+  }
+
+ private:
+  template <size_t... index, typename... bound_type>
+  [[nodiscard]] static inline JSValueRef invoke_with(
+      function_type& function, const native_call& call,
+      std::index_sequence<index...>, bound_type&&... bound) {
+    // Braced initialization converts the arguments from left to right
+    args_type args{
+        call.get<std::tuple_element_t<index, args_type>>(index)...};
+    if (call.threw()) {
+      return call.undefined();
+    }
+    if constexpr (std::is_same_v<result_type, void>) {
+      std::invoke(function, std::forward<bound_type>(bound)...,
+                  std::move(std::get<index>(args))...);
+      return call.undefined();
+    } else {
+      return convert<std::decay_t<result_type>>::to(
+          call.ctx, std::invoke(function, std::forward<bound_type>(bound)...,
+                                std::move(std::get<index>(args))...));
+    }
+  }
+};
+
+}  // namespace jsc::details
+
+#endif  // jsc_function_hpp
@@ -0,0 +1,48 @@
+#ifndef jsc_handle_scope_hpp
+#define jsc_handle_scope_hpp
+
+#include <JavaScriptCore/JavaScriptCore.h>
+#include <unordered_set>
+
+#include "instrument.hpp"
+
+namespace jsc {
+
+struct context;
+struct object;
+struct value;
+
+// While a scope is alive, wrappers created on its context are rooted by the
+// scope instead of protecting themselves: each distinct value is protected
+// once and released when the scope ends, and copies, moves and destruction of
+// the wrappers never reach the engine. Such wrappers must not outlive the
+// scope unless they are passed through escape().
+struct handle_scope {
+  friend context;
+
+  explicit handle_scope(context& ctx);
+  ~handle_scope();
+
+  handle_scope(const handle_scope&) = delete;
+  handle_scope& operator=(const handle_scope&) = delete;
+
+  [[nodiscard]] value escape(value val) const;
+  [[nodiscard]] object escape(object obj) const;
+
+ private:
+  context& _ctx;
+  JSGlobalContextRef _ref;
+  handle_scope* _parent;
+  std::unordered_set<JSValueRef> _rooted;
+
+  inline void add(JSValueRef val) {
+    if (_rooted.insert(val).second) {
+      details::count(details::counter::protect);
+      JSValueProtect(_ref, val);
+    }
+  }
+};
+
+}  // namespace jsc
+
+#endif  // jsc_handle_scope_hpp
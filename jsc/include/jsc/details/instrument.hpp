@@ -0,0 +1,174 @@
+#ifndef jsc_instrument_hpp
+#define jsc_instrument_hpp
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Building with -DJSC_INSTRUMENT=ON defines JSC_INSTRUMENT for the library
+// and its users, which turns on the counters and trace spans below. Without
+// it they compile to nothing and always read zero.
+
+namespace jsc {
+
+// Work done by the wrapper itself, summed over all threads
+struct wrapper_counters {
+  size_t protects;
+  size_t unprotects;
+  size_t strings_created;
+  size_t try_throwables;
+  size_t containers;
+  size_t instances;
+  size_t callbacks;
+};
+
+namespace details {
+
+struct entry_scope;
+
+enum class counter {
+  protect,
+  unprotect,
+  string_created,
+  try_throwable,
+  container,
+  instance,
+  callback,
+  count
+};
+
+#ifdef JSC_INSTRUMENT
+inline std::atomic<size_t>
+    counter_values[static_cast<size_t>(counter::count)]{};
+#endif
+
+inline void count([[maybe_unused]] counter which) {
+#ifdef JSC_INSTRUMENT
+  counter_values[static_cast<size_t>(which)].fetch_add(
+      1, std::memory_order_relaxed);
+#endif
+}
+
+[[nodiscard]] inline size_t counted([[maybe_unused]] counter which) {
+#ifdef JSC_INSTRUMENT
+  return counter_values[static_cast<size_t>(which)].load(
+      std::memory_order_relaxed);
+#else
+  return 0;
+#endif
+}
+
+}  // namespace details
+
+[[nodiscard]] inline wrapper_counters read_wrapper_counters() {
+  using details::counter;
+  using details::counted;
+  return {counted(counter::protect),        counted(counter::unprotect),
+          counted(counter::string_created), counted(counter::try_throwable),
+          counted(counter::container),      counted(counter::instance),
+          counted(counter::callback)};
+}
+
+inline void reset_wrapper_counters() {
+#ifdef JSC_INSTRUMENT
+  for (auto& value : details::counter_values) {
+    value.store(0, std::memory_order_relaxed);
+  }
+#endif
+}
+
+// Records eval_script(), object::call() and native callbacks on every thread
+// as spans of the Chrome trace-event format, for chrome://tracing or
+// Perfetto. Only one recorder is active at a time, and start() stops the one it
+// replaces. Stopping waits for the spans still open on other threads, so
+// neither start() nor stop() may be called from inside a traced call or
+// callback.
+struct trace_recorder {
+  friend struct details::entry_scope;
+
+  trace_recorder() = default;
+  inline ~trace_recorder() { stop(); }
+
+  trace_recorder(const trace_recorder&) = delete;
+  trace_recorder& operator=(const trace_recorder&) = delete;
+
+  void start();
+  void stop();
+
+  // {"traceEvents": [...]} with one complete ("X") event per span
+  [[nodiscard]] inline std::string json() const {
+    std::string result;
+    json(result);
+    return result;
+  }
+  void json(std::string& out) const;
+
+ private:
+  using clock = std::chrono::steady_clock;
+
+  struct span {
+    const char* category;
+    std::string name;
+    clock::time_point start;
+    clock::time_point end;
+    std::thread::id thread;
+  };
+
+  clock::time_point _origin{clock::now()};
+  mutable std::mutex _mutex;
+  std::vector<span> _spans;
+
+  void record(const char* category, std::string name,
+              clock::time_point start);
+};
+
+namespace details {
+
+inline std::atomic<trace_recorder*> active_recorder{nullptr};
+// Spans that hold on to the active recorder until they are recorded
+inline std::atomic<size_t> spans_in_flight{0};
+
+// Whether a span opened now would be recorded, without acquiring the recorder
+[[nodiscard]] inline bool recording() {
+#ifdef JSC_INSTRUMENT
+  return active_recorder.load(std::memory_order_relaxed) != nullptr;
+#else
+  return false;
+#endif
+}
+
+// The recorder that an opening span should report to, or none when the library
+// is built without JSC_INSTRUMENT. A non-null result must be handed back with
+// release_recorder() once the span is recorded.
+inline trace_recorder* acquire_recorder() {
+#ifdef JSC_INSTRUMENT
+  const auto recorder{active_recorder.load(std::memory_order_acquire)};
+  if (recorder == nullptr) {
+    return nullptr;
+  }
+  spans_in_flight.fetch_add(1, std::memory_order_seq_cst);
+  // stop() may have run between the load and the increment without seeing it
+  if (active_recorder.load(std::memory_order_seq_cst) != recorder) {
+    spans_in_flight.fetch_sub(1, std::memory_order_release);
+    return nullptr;
+  }
+  return recorder;
+#else
+  return nullptr;
+#endif
+}
+
+inline void release_recorder() {
+  spans_in_flight.fetch_sub(1, std::memory_order_release);
+}
+
+}  // namespace details
+
+}  // namespace jsc
+
+#endif  // jsc_instrument_hpp
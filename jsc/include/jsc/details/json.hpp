@@ -0,0 +1,184 @@
+#ifndef jsc_json_hpp
+#define jsc_json_hpp
+
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "fields.hpp"
+
+namespace jsc {
+
+// Streams JSON text into a caller-owned string, reusing its capacity. Scalars,
+// strings, optionals, iterable containers and structs with declared
+// jsc::fields are written directly; any other type is written by a
+// to_json(json_writer&, const T&) overload found by ADL:
+//   void to_json(jsc::json_writer& w, const point& p) {
+//     w.begin_object().field("x", p.x).field("y", p.y).end_object();
+//   }
+struct json_writer {
+  inline explicit json_writer(std::string& out) : _out{out} {}
+
+  inline json_writer& begin_object() {
+    separate();
+    _out.push_back('{');
+    _needs_comma = false;
+    return *this;
+  }
+  inline json_writer& end_object() {
+    _out.push_back('}');
+    _needs_comma = true;
+    return *this;
+  }
+  inline json_writer& begin_array() {
+    separate();
+    _out.push_back('[');
+    _needs_comma = false;
+    return *this;
+  }
+  inline json_writer& end_array() {
+    _out.push_back(']');
+    _needs_comma = true;
+    return *this;
+  }
+
+  inline json_writer& key(std::string_view name) {
+    separate();
+    append_string(name);
+    _out.push_back(':');
+    _needs_comma = false;
+    return *this;
+  }
+  template <typename val_type>
+  inline json_writer& field(std::string_view name, const val_type& val) {
+    key(name);
+    return write(val);
+  }
+
+  inline json_writer& null() {
+    separate();
+    _out.append("null");
+    return *this;
+  }
+
+  template <typename val_type>
+  inline json_writer& write(const val_type& val) {
+    if constexpr (std::is_same_v<val_type, bool>) {
+      separate();
+      _out.append(val ? "true" : "false");
+    } else if constexpr (std::is_integral_v<val_type>) {
+      separate();
+      append_chars(val);
+    } else if constexpr (std::is_floating_point_v<val_type>) {
+      // Like JSON.stringify, NaN and infinities become null
+      if (!std::isfinite(val)) {
+        return null();
+      }
+      separate();
+      append_chars(val);
+    } else if constexpr (std::is_convertible_v<const val_type&,
+                                               std::string_view>) {
+      separate();
+      append_string(val);
+    } else if constexpr (std::is_same_v<val_type, std::nullptr_t>) {
+      return null();
+    } else if constexpr (is_optional<val_type>::value) {
+      return val.has_value() ? write(*val) : null();
+    } else if constexpr (is_iterable<val_type>::value) {
+      begin_array();
+      for (const auto& elem : val) {
+        write(elem);
+      }
+      end_array();
+    } else if constexpr (has_fields<val_type>::value) {
+      begin_object();
+      details::for_each_field<val_type>([this, &val](size_t, const auto& info) {
+        field(info.name, val.*info.member);
+      });
+      end_object();
+    } else {
+      to_json(*this, val);
+    }
+    return *this;
+  }
+
+ private:
+  std::string& _out;
+  bool _needs_comma{false};
+
+  template <typename type>
+  struct is_optional : std::false_type {};
+  template <typename type>
+  struct is_optional<std::optional<type>> : std::true_type {};
+
+  template <typename type, typename = void>
+  struct is_iterable : std::false_type {};
+  template <typename type>
+  struct is_iterable<type, std::void_t<decltype(std::begin(
+                                           std::declval<const type&>())),
+                                       decltype(std::end(
+                                           std::declval<const type&>()))>>
+      : std::true_type {};
+
+  // Called before every value; a key resets it so its value is not separated
+  inline void separate() {
+    if (_needs_comma) {
+      _out.push_back(',');
+    }
+    _needs_comma = true;
+  }
+
+  template <typename num_type>
+  inline void append_chars(num_type num) {
+    char buffer[32];
+    _out.append(buffer,
+                std::to_chars(buffer, buffer + sizeof(buffer), num).ptr);
+  }
+
+  // Runs without escapes are appended in one call
+  inline void append_string(std::string_view str) {
+    static constexpr char hex[]{"0123456789abcdef"};
+    _out.push_back('"');
+    size_t run{0};
+    for (size_t i{0}; i < str.size(); i++) {
+      const auto c{static_cast<unsigned char>(str[i])};
+      if (c >= 0x20 && c != '"' && c != '\\') {
+        continue;
+      }
+      _out.append(str.data() + run, i - run);
+      run = i + 1;
+      switch (c) {
+        case '"':
+          _out.append("\\\"");
+          break;
+        case '\\':
+          _out.append("\\\\");
+          break;
+        case '\n':
+          _out.append("\\n");
+          break;
+        case '\r':
+          _out.append("\\r");
+          break;
+        case '\t':
+          _out.append("\\t");
+          break;
+        default:
+          _out.append("\\u00");
+          _out.push_back(hex[c >> 4]);
+          _out.push_back(hex[c & 0xf]);
+      }
+    }
+    _out.append(str.data() + run, str.size() - run);
+    _out.push_back('"');
+  }
+};
+
+}  // namespace jsc
+
+#endif  // jsc_json_hpp
@@ -0,0 +1,41 @@
+#ifndef jsc_key_hpp
+#define jsc_key_hpp
+
+#include <JavaScriptCore/JavaScriptCore.h>
+#include <string>
+#include <string_view>
+
+#include "string.hpp"
+
+namespace jsc {
+
+// Property name whose engine string is created once and can be reused for
+// any number of lookups on any context.
+struct key {
+  inline key(const char* name) : _str{name} {}
+  inline key(const std::string& name) : _str{name} {}
+
+  // Returns the key for name from a process-wide, thread-safe cache. Once the
+  // cache is full, new names get a fresh key that is not cached.
+  [[nodiscard]] static key intern(std::string_view name);
+
+  [[nodiscard]] inline std::string name() const { return _str.get(); }
+  [[nodiscard]] inline JSStringRef managed_ref() const {
+    return _str.managed_ref();
+  }
+
+ private:
+  details::string_wrapper _str;
+};
+
+}  // namespace jsc
+
+// Key for a string literal, created the first time the expression runs and
+// shared by every later evaluation, e.g. obj[JSC_KEY("length")]
+#define JSC_KEY(name)                       \
+  ([]() -> const ::jsc::key& {              \
+    static const ::jsc::key _jsc_key{name}; \
+    return _jsc_key;                        \
+  }())
+
+#endif  // jsc_key_hpp
@@ -0,0 +1,37 @@
+#ifndef jsc_mapped_file_hpp
+#define jsc_mapped_file_hpp
+
+#include <string>
+#include <string_view>
+
+namespace jsc::details {
+
+// Read-only memory mapping of a whole file
+struct mapped_file {
+  explicit mapped_file(const std::string& path);
+  ~mapped_file();
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  [[nodiscard]] inline bool is_open() const noexcept { return _open; }
+  [[nodiscard]] inline std::string_view view() const noexcept {
+    return {static_cast<const char*>(_data), _size};
+  }
+  // The system zero-fills the rest of the last page of a mapping, so unless
+  // the file size is a multiple of the page size the contents are followed by
+  // a NUL and can be passed on as a C string.
+  [[nodiscard]] inline bool is_null_terminated() const noexcept {
+    return _size > 0 && _size % _page_size != 0;
+  }
+
+ private:
+  void* _data{nullptr};
+  size_t _size{0};
+  size_t _page_size{1};
+  bool _open{false};
+};
+
+}  // namespace jsc::details
+
+#endif  // jsc_mapped_file_hpp
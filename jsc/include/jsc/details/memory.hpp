@@ -0,0 +1,77 @@
+#ifndef jsc_memory_hpp
+#define jsc_memory_hpp
+
+#include <JavaScriptCore/JavaScriptCore.h>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// Exported by JavaScriptCore but declared only in its private headers
+extern "C" {
+JS_EXPORT void JSReportExtraMemoryCost(JSContextRef ctx, size_t size);
+JS_EXPORT JSObjectRef JSGetMemoryUsageStatistics(JSContextRef ctx);
+}
+
+namespace jsc {
+
+// Memory a container keeps alive outside the garbage-collected heap, reported
+// to the collector when the container is made. Specialize for types that own
+// other allocations; by default the object itself is counted, plus the
+// capacity of types with contiguous storage such as vectors and strings.
+template <typename type, typename = void>
+struct external_size {
+  [[nodiscard]] static inline size_t of(const type&) { return sizeof(type); }
+};
+template <typename type>
+struct external_size<type,
+                     std::void_t<typename type::value_type,
+                                 decltype(std::declval<const type&>().data()),
+                                 decltype(std::declval<const type&>()
+                                              .capacity())>> {
+  [[nodiscard]] static inline size_t of(const type& obj) {
+    return sizeof(type) + obj.capacity() * sizeof(typename type::value_type);
+  }
+};
+
+struct memory_statistics {
+  // Garbage-collected heap, as reported by the engine
+  size_t heap_size;
+  size_t heap_capacity;
+  size_t extra_memory;
+  size_t object_count;
+  size_t protected_object_count;
+  // Bytes held by live containers of all contexts in the process
+  size_t container_bytes;
+};
+
+namespace details {
+
+inline std::atomic<size_t> container_bytes{0};
+
+// Storage behind context::container, remembering the size it reported so the
+// finalizer can take the same amount off container_bytes
+template <typename object_type>
+struct container_box {
+  object_type object;
+  size_t size;
+
+  template <typename... arg_type>
+  inline explicit container_box(arg_type&&... args)
+      : object{std::forward<arg_type>(args)...},
+        size{external_size<object_type>::of(object)} {
+    container_bytes.fetch_add(size, std::memory_order_relaxed);
+  }
+  inline ~container_box() {
+    container_bytes.fetch_sub(size, std::memory_order_relaxed);
+  }
+
+  container_box(const container_box&) = delete;
+  container_box& operator=(const container_box&) = delete;
+};
+
+}  // namespace details
+
+}  // namespace jsc
+
+#endif  // jsc_memory_hpp
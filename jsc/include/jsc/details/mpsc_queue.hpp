@@ -0,0 +1,79 @@
+#ifndef jsc_mpsc_queue_hpp
+#define jsc_mpsc_queue_hpp
+
+#include <atomic>
+
+namespace jsc {
+
+namespace details {
+
+// Lock-free multi-producer, single-consumer queue. Producers push onto an
+// intrusive stack with one compare-and-swap; the consumer takes the whole
+// stack with one exchange and reverses it to recover push order.
+template <typename elem_type>
+struct mpsc_queue {
+  mpsc_queue() = default;
+  inline ~mpsc_queue() {
+    auto head{_head.exchange(nullptr, std::memory_order_acquire)};
+    while (head != nullptr) {
+      const auto next{head->next};
+      delete head;
+      head = next;
+    }
+  }
+
+  mpsc_queue(const mpsc_queue&) = delete;
+  mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+  // Safe from any thread. Returns whether the queue was empty, i.e. whether a
+  // sleeping consumer needs to be woken.
+  inline bool push(elem_type elem) {
+    const auto pushed{new node{std::move(elem), nullptr}};
+    // The node belongs to the consumer once published, so the old head is
+    // kept here rather than read back from it
+    auto expected{_head.load(std::memory_order_relaxed)};
+    do {
+      pushed->next = expected;
+    } while (!_head.compare_exchange_weak(expected, pushed,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed));
+    return expected == nullptr;
+  }
+
+  // Consumer only: passes every queued element to out, oldest first
+  template <typename callback_type>
+  inline void drain(callback_type out) {
+    node* reversed{nullptr};
+    auto head{_head.exchange(nullptr, std::memory_order_acquire)};
+    while (head != nullptr) {
+      const auto next{head->next};
+      head->next = reversed;
+      reversed = head;
+      head = next;
+    }
+    while (reversed != nullptr) {
+      const auto next{reversed->next};
+      out(std::move(reversed->elem));
+      delete reversed;
+      reversed = next;
+    }
+  }
+
+  [[nodiscard]] inline bool empty() const {
+    return _head.load(std::memory_order_acquire) == nullptr;
+  }
+
+ private:
+  struct node {
+    elem_type elem;
+    node* next;
+  };
+
+  std::atomic<node*> _head{nullptr};
+};
+
+}  // namespace details
+
+}  // namespace jsc
+
+#endif  // jsc_mpsc_queue_hpp
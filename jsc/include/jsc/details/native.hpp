@@ -0,0 +1,97 @@
+#ifndef jsc_native_hpp
+#define jsc_native_hpp
+
+#include <JavaScriptCore/JavaScriptCore.h>
+
+#include "convert.hpp"
+
+namespace jsc {
+
+// Non-owning view over the arguments of a call from JS
+struct arguments {
+  const JSValueRef* data;
+  size_t count;
+
+  [[nodiscard]] inline size_t size() const noexcept { return count; }
+  [[nodiscard]] inline const JSValueRef* begin() const noexcept {
+    return data;
+  }
+  [[nodiscard]] inline const JSValueRef* end() const noexcept {
+    return data + count;
+  }
+  [[nodiscard]] inline JSValueRef operator[](size_t i) const noexcept {
+    return data[i];
+  }
+};
+
+// Raw state of a call from JS into a function made by context::native. Refs
+// are valid for the duration of the call only, and nothing here protects or
+// allocates.
+struct native_call {
+  JSContextRef ctx;
+  JSObjectRef function;
+  JSObjectRef this_object;
+  arguments args;
+  JSValueRef* exception;
+
+  [[nodiscard]] inline size_t size() const noexcept { return args.count; }
+
+  // Missing arguments read as undefined, as they do in JS
+  [[nodiscard]] inline JSValueRef arg(size_t i) const {
+    return i < args.count ? args[i] : JSValueMakeUndefined(ctx);
+  }
+
+  template <typename type>
+  [[nodiscard]] inline type get(size_t i) const {
+    return convert<type>::from(ctx, arg(i), exception);
+  }
+
+  template <typename type>
+  [[nodiscard]] inline JSValueRef make(const type& val) const {
+    return convert<type>::to(ctx, val);
+  }
+
+  [[nodiscard]] inline JSValueRef undefined() const {
+    return JSValueMakeUndefined(ctx);
+  }
+
+  // Throws an Error with message in JS once the callback returns
+  inline void throw_error(const char* message) const {
+    throw_message(convert<const char*>::to(ctx, message));
+  }
+  inline void throw_error(const std::string& message) const {
+    throw_message(convert<std::string>::to(ctx, message));
+  }
+
+  // Throws a TypeError, e.g. for a receiver of the wrong type
+  inline void throw_type_error(const char* message) const {
+    const auto name{JSStringCreateWithUTF8CString("TypeError")};
+    const auto constructor{JSObjectGetProperty(
+        ctx, JSContextGetGlobalObject(ctx), name, nullptr)};
+    JSStringRelease(name);
+    const auto message_ref{convert<const char*>::to(ctx, message)};
+    if (constructor != nullptr && JSValueIsObject(ctx, constructor)) {
+      JSValueRef thrown{nullptr};
+      const auto error{JSObjectCallAsConstructor(
+          ctx, JSValueToObject(ctx, constructor, nullptr), 1, &message_ref,
+          &thrown)};
+      *exception = error != nullptr ? error : thrown;
+    }
+    if (*exception == nullptr) {
+      throw_message(message_ref);
+    }
+  }
+
+  [[nodiscard]] inline bool threw() const noexcept {
+    return *exception != nullptr;
+  }
+
+ private:
+  inline void throw_message(JSValueRef message) const {
+    *exception = JSObjectMakeError(ctx, 1, &message, nullptr);
+  }
+};
+
+}  // namespace jsc
+
+#endif  // jsc_native_hpp
@@ -2,17 +2,24 @@
 #define jsc_object_hpp
 
 #include <type_traits>
+#include <vector>
 
+#include "key.hpp"
+#include "memory.hpp"
 #include "string.hpp"
+#include "typed_array.hpp"
 #include "value.hpp"
 
 namespace jsc {
 
 struct context;
+struct handle_scope;
 template <typename property_type>
 struct property;
 
 struct object {
+  friend context;
+  friend handle_scope;
   template <typename property_type>
   friend struct property;
 
@@ -21,10 +28,18 @@ struct object {
 
   object(const object& obj);
   object& operator=(const object& obj);
+  object(object&& obj) noexcept;
+  object& operator=(object&& obj) noexcept;
 
   inline operator value() const { return {*_ctx, _ref}; }
 
-  property<details::string_wrapper> operator[](const std::string& name) const;
+  // Names looked up by string go through the key cache, see key::intern. A
+  // template, so a literal 0 cannot convert to it and obj[0] stays an index.
+  template <typename char_type,
+            typename = std::enable_if_t<std::is_same_v<char_type, char>>>
+  property<key> operator[](const char_type* name) const;
+  property<key> operator[](const std::string& name) const;
+  property<key> operator[](const key& name) const;
   property<unsigned int> operator[](unsigned int index) const;
 
   [[nodiscard]] bool is_function() const;
@@ -35,7 +50,29 @@ struct object {
   template <typename object_type>
   [[nodiscard]] object_type* get_contained() const {
     assert(is_container<object_type>());
-    return static_cast<object_type*>(JSObjectGetPrivate(_ref));
+    return &static_cast<details::container_box<object_type>*>(
+                JSObjectGetPrivate(_ref))
+                ->object;
+  }
+
+  // kJSTypedArrayTypeNone for objects that are neither typed arrays nor
+  // ArrayBuffers
+  [[nodiscard]] JSTypedArrayType typed_array_type() const;
+
+  // Direct access to the elements of a typed array created on either side
+  template <typename elem_type>
+  [[nodiscard]] typed_array_view<elem_type> typed_array_data() const;
+  [[nodiscard]] typed_array_view<uint8_t> array_buffer_data() const;
+
+  // Reads an array-like object into out with a single length lookup; typed
+  // arrays of the matching element type are copied in bulk.
+  template <typename elem_type>
+  void copy_to(std::vector<elem_type>& out) const;
+  template <typename elem_type>
+  [[nodiscard]] inline std::vector<elem_type> to_vector() const {
+    std::vector<elem_type> result;
+    copy_to(result);
+    return result;
   }
 
   template <typename... arg_type>
@@ -52,21 +89,24 @@ struct object {
  private:
   context* _ctx;
   JSObjectRef _ref;
+  bool _owned;
+
+  void own();
 
-  [[nodiscard]] bool has_property(const details::string_wrapper& name) const;
+  [[nodiscard]] bool has_property(const key& name) const;
   [[nodiscard]] inline bool has_property(unsigned int index) const {
     return has_property(std::to_string(index));
   }
 
-  bool remove_property(const details::string_wrapper& name) const;
+  bool remove_property(const key& name) const;
   inline bool remove_property(unsigned int index) const {
     return remove_property(std::to_string(index));
   }
 
-  [[nodiscard]] value get_property(const details::string_wrapper& name) const;
+  [[nodiscard]] value get_property(const key& name) const;
   [[nodiscard]] value get_property(unsigned int index) const;
 
-  void set_property(const details::string_wrapper& name,
+  void set_property(const key& name,
                     const value& val) const;
   void set_property(unsigned int index, const value& val) const;
   template <typename property_type, typename val_type,
@@ -25,12 +25,58 @@ struct parameter_pack_counter<t0, types...> {
 
 }  // namespace utils
 
+template <typename char_type, typename>
+property<key> object::operator[](const char_type* name) const {
+  return {*this, key::intern(name)};
+}
+
 template <typename object_type>
 [[nodiscard]] bool object::is_container() const {
   return JSValueIsObjectOfClass(_ctx->_ref, _ref,
                                 context::container_class<object_type>());
 }
 
+template <typename elem_type>
+[[nodiscard]] typed_array_view<elem_type> object::typed_array_data() const {
+  assert(typed_array_type() == typed_array_type_for<elem_type>);
+  return _ctx->try_throwable([this](auto exception)
+                                 -> typed_array_view<elem_type> {
+    // The bytes pointer is the start of the underlying buffer
+    const auto bytes{static_cast<uint8_t*>(
+        JSObjectGetTypedArrayBytesPtr(_ctx->_ref, _ref, exception))};
+    const auto offset{
+        JSObjectGetTypedArrayByteOffset(_ctx->_ref, _ref, exception)};
+    const auto length{
+        JSObjectGetTypedArrayLength(_ctx->_ref, _ref, exception)};
+    if (bytes == nullptr) {
+      return {nullptr, 0};
+    }
+    return {reinterpret_cast<elem_type*>(bytes + offset), length};
+  });
+}
+
+template <typename elem_type>
+void object::copy_to(std::vector<elem_type>& out) const {
+  if constexpr (is_typed_array_element<elem_type>) {
+    if (typed_array_type() == typed_array_type_for<elem_type>) {
+      const auto view{typed_array_data<elem_type>()};
+      out.assign(view.begin(), view.end());
+      return;
+    }
+  }
+
+  _ctx->try_throwable([this, &out](auto exception) {
+    details::read_array(
+        _ctx->_ref, _ref, out, exception, [this, exception](JSValueRef elem) {
+          if constexpr (std::is_same_v<elem_type, value>) {
+            return value{*_ctx, elem};
+          } else {
+            return convert<elem_type>::from(_ctx->_ref, elem, exception);
+          }
+        });
+  });
+}
+
 template <typename property_type, typename val_type, typename>
 inline void object::set_property(const property_type& prop,
                                  val_type&& val) const {
@@ -40,6 +86,9 @@ inline void object::set_property(const property_type& prop,
 template <typename... arg_type>
 value object::callWithThisRef(JSObjectRef obj, arg_type&&... args) const {
   assert(is_function());
+  const details::entry_scope entry{"call", [this] {
+    return details::entry_name(_ctx->_ref, _ref);
+  }};
   if constexpr (utils::parameter_pack_count<arg_type...> == 0) {
     return {*_ctx, _ctx->try_throwable([this, &obj](auto exception) {
               return JSObjectCallAsFunction(_ctx->_ref, _ref, obj, 0, nullptr,
@@ -50,7 +99,7 @@ value object::callWithThisRef(JSObjectRef obj, arg_type&&... args) const {
         transform_arg(std::forward<arg_type>(args))...};
     std::array<JSValueRef, arg_list.size()> ref_list;
     std::transform(arg_list.begin(), arg_list.end(), ref_list.begin(),
-                   [](const auto val) { return val.ref(); });
+                   [](const auto& val) { return val.ref(); });
 
     return {*_ctx, _ctx->try_throwable([this, &obj, &ref_list](auto exception) {
               return JSObjectCallAsFunction(_ctx->_ref, _ref, obj,
@@ -0,0 +1,164 @@
+#ifndef jsc_profiler_hpp
+#define jsc_profiler_hpp
+
+#include <JavaScriptCore/JavaScriptCore.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "instrument.hpp"
+
+namespace jsc {
+
+struct profiler;
+
+namespace details {
+
+struct entry_scope;
+
+inline thread_local profiler* active_profiler{nullptr};
+
+}  // namespace details
+
+// Times the entries into the engine made on the thread that called start():
+// eval_script() by source URL, object::call() and native callbacks by function
+// name. Each entry gets its cumulative time, counted once across recursion,
+// and its self time, which excludes nested entries.
+//
+// With a sample interval, a helper thread also records which stack of entries
+// is running at that rate. Scripts cannot be walked from another thread, so
+// the stacks are made of these entries rather than of every JS frame.
+struct profiler {
+  friend struct details::entry_scope;
+
+  struct entry {
+    std::string name;
+    size_t calls;
+    std::chrono::nanoseconds total;
+    std::chrono::nanoseconds self;
+    size_t samples;
+  };
+
+  inline explicit profiler(std::chrono::microseconds sample_interval =
+                               std::chrono::microseconds::zero())
+      : _interval{sample_interval} {
+    _nodes.push_back({0, 0, {}, {}});
+  }
+  inline ~profiler() { stop(); }
+
+  profiler(const profiler&) = delete;
+  profiler& operator=(const profiler&) = delete;
+
+  void start();
+  void stop();
+
+  // Sorted by self time, hottest first; read after stop(), as the entries are
+  // updated by the profiled thread without locking
+  [[nodiscard]] std::vector<entry> entries() const;
+  // One "outer;inner weight" line per stack, as read by flamegraph.pl. The
+  // weight is the sample count when sampling, otherwise self microseconds.
+  [[nodiscard]] inline std::string folded() const {
+    std::string result;
+    folded(result);
+    return result;
+  }
+  void folded(std::string& out) const;
+
+ private:
+  using clock = std::chrono::steady_clock;
+
+  // One per distinct stack of entry names; node 0 is the thread outside any
+  // entry
+  struct node {
+    size_t name;
+    size_t parent;
+    std::unordered_map<size_t, size_t> children;
+    std::chrono::nanoseconds self;
+  };
+  struct frame {
+    size_t node;
+    clock::time_point start;
+    std::chrono::nanoseconds nested;
+  };
+
+  std::chrono::microseconds _interval;
+  std::unordered_map<std::string, size_t> _ids;
+  std::vector<entry> _entries;
+  // Frames of each name on the stack, so recursion adds to total once
+  std::vector<size_t> _depth;
+  std::vector<node> _nodes;
+  std::vector<frame> _stack;
+
+  // Shared with the sampler, which only reads _current and updates _samples
+  // under _mutex
+  std::atomic<size_t> _current{0};
+  std::unordered_map<size_t, size_t> _samples;
+  std::thread _sampler;
+  mutable std::mutex _mutex;
+  std::condition_variable _wake;
+  bool _sampling{false};
+
+  void enter(const std::string& name);
+  void leave();
+  void sample();
+};
+
+namespace details {
+
+// Name of an entry: the source URL of a script, or the name property of a
+// function
+[[nodiscard]] std::string entry_name(JSStringRef url);
+[[nodiscard]] std::string entry_name(JSContextRef ctx, JSObjectRef function);
+
+// Reports the enclosing block, an entry into the engine or a native
+// callback, to the thread's active profiler and to the active trace_recorder.
+// The name is computed once, and only if either of them is listening.
+struct entry_scope {
+  template <typename name_type>
+  inline entry_scope(const char* category, const name_type& name)
+      : _profiler{active_profiler}, _category{category} {
+    if (_profiler == nullptr && !recording()) {
+      return;
+    }
+    _name = name();
+    if (_profiler != nullptr) {
+      _profiler->enter(_name);
+    }
+    // Last, as nothing would release the recorder if the above threw
+    _recorder = acquire_recorder();
+    if (_recorder != nullptr) {
+      _start = trace_recorder::clock::now();
+    }
+  }
+  inline ~entry_scope() {
+    if (_profiler != nullptr) {
+      _profiler->leave();
+    }
+    if (_recorder != nullptr) {
+      _recorder->record(_category, std::move(_name), _start);
+      release_recorder();
+    }
+  }
+
+  entry_scope(const entry_scope&) = delete;
+  entry_scope& operator=(const entry_scope&) = delete;
+
+ private:
+  profiler* _profiler;
+  trace_recorder* _recorder{nullptr};
+  const char* _category;
+  std::string _name;
+  trace_recorder::clock::time_point _start;
+};
+
+}  // namespace details
+
+}  // namespace jsc
+
+#endif  // jsc_profiler_hpp
@@ -0,0 +1,50 @@
+#ifndef jsc_script_hpp
+#define jsc_script_hpp
+
+#include <string>
+#include <string_view>
+
+#include "string.hpp"
+
+namespace jsc {
+
+// Script source whose engine strings are created once. Evaluating the same
+// script again, in the same context or in any context of the same group, lets
+// the engine reuse its cached compilation of the source instead of
+// re-creating and re-parsing the strings; see context::eval_script,
+// context::check_syntax and context::compile.
+struct script {
+  inline script(const char* source,
+                const std::string& source_url = "<anonymous>",
+                int starting_line = 1)
+      : _source{source}, _url{source_url}, _line{starting_line} {}
+  inline script(const std::string& source,
+                const std::string& source_url = "<anonymous>",
+                int starting_line = 1)
+      : _source{source}, _url{source_url}, _line{starting_line} {}
+  inline script(std::string_view source,
+                const std::string& source_url = "<anonymous>",
+                int starting_line = 1)
+      : _source{source}, _url{source_url}, _line{starting_line} {}
+  inline script(std::u16string_view source,
+                const std::string& source_url = "<anonymous>",
+                int starting_line = 1)
+      : _source{source}, _url{source_url}, _line{starting_line} {}
+
+  [[nodiscard]] inline JSStringRef source_ref() const {
+    return _source.managed_ref();
+  }
+  [[nodiscard]] inline JSStringRef url_ref() const {
+    return _url.managed_ref();
+  }
+  [[nodiscard]] inline int starting_line() const noexcept { return _line; }
+
+ private:
+  details::string_wrapper _source;
+  details::string_wrapper _url;
+  int _line;
+};
+
+}  // namespace jsc
+
+#endif  // jsc_script_hpp
@@ -3,14 +3,62 @@
 
 #include <JavaScriptCore/JavaScriptCore.h>
 #include <string>
+#include <string_view>
+
+#include "instrument.hpp"
+#include "utf.hpp"
 
 namespace jsc::details {
 
+// The calling thread's reused buffer of string_type, cleared on construction.
+// Buffers that grew past 1 MiB are released on destruction so that one large
+// value does not pin the memory for the life of the thread. Scratch buffers of
+// the same type must not be nested.
+template <typename string_type>
+struct scratch_buffer {
+  inline scratch_buffer() : _buffer{storage()} { _buffer.clear(); }
+  inline ~scratch_buffer() {
+    if (_buffer.capacity() > (1 << 20)) {
+      string_type{}.swap(_buffer);
+    }
+  }
+
+  scratch_buffer(const scratch_buffer&) = delete;
+  scratch_buffer& operator=(const scratch_buffer&) = delete;
+
+  [[nodiscard]] inline string_type& operator*() noexcept { return _buffer; }
+  [[nodiscard]] inline string_type* operator->() noexcept { return &_buffer; }
+
+ private:
+  string_type& _buffer;
+
+  [[nodiscard]] static inline string_type& storage() {
+    thread_local string_type buffer;
+    return buffer;
+  }
+};
+
 struct string_wrapper {
   inline string_wrapper(const std::string& str)
-      : _ref{JSStringCreateWithUTF8CString(str.data())} {}
+      : _ref{JSStringCreateWithUTF8CString(str.data())} {
+    count(counter::string_created);
+  }
   inline string_wrapper(const char* str)
-      : _ref{JSStringCreateWithUTF8CString(str)} {}
+      : _ref{JSStringCreateWithUTF8CString(str)} {
+    count(counter::string_created);
+  }
+  // Input that is not NUL-terminated is decoded into a reused UTF-16 buffer
+  // instead of being copied into a terminated string first
+  inline string_wrapper(std::string_view str) : _ref{create(str)} {
+    count(counter::string_created);
+  }
+  // UTF-16 input is copied as is, without transcoding or scanning for NUL
+  inline string_wrapper(std::u16string_view str)
+      : _ref{JSStringCreateWithCharacters(
+            reinterpret_cast<const JSChar*>(str.data()), str.size())} {
+    static_assert(sizeof(JSChar) == sizeof(char16_t));
+    count(counter::string_created);
+  }
   inline string_wrapper(JSStringRef unmanaged) : _ref{unmanaged} {}
   inline ~string_wrapper() { JSStringRelease(_ref); }
 
@@ -24,16 +72,33 @@ struct string_wrapper {
     return *this;
   }
 
+  // Converts straight from the engine's UTF-16 buffer into one exactly sized
+  // allocation, or into out to reuse its capacity
   [[nodiscard]] inline std::string get() const {
-    const auto length{JSStringGetMaximumUTF8CStringSize(_ref)};
-    auto buffer{std::make_unique<char[]>(length)};
-    JSStringGetUTF8CString(_ref, buffer.get(), length);
-    return buffer.get();
+    std::string result;
+    get(result);
+    return result;
+  }
+  inline void get(std::string& out) const {
+    out.clear();
+    append_utf8(view(), out);
+  }
+  // Valid while this wrapper is alive
+  [[nodiscard]] inline std::u16string_view view() const {
+    return {reinterpret_cast<const char16_t*>(JSStringGetCharactersPtr(_ref)),
+            JSStringGetLength(_ref)};
   }
   [[nodiscard]] inline JSStringRef managed_ref() const { return _ref; }
 
  private:
   JSStringRef _ref;
+
+  [[nodiscard]] static inline JSStringRef create(std::string_view str) {
+    scratch_buffer<std::u16string> buffer;
+    append_utf16(str, *buffer);
+    return JSStringCreateWithCharacters(
+        reinterpret_cast<const JSChar*>(buffer->data()), buffer->size());
+  }
 };
 
 }  // namespace jsc::details
@@ -0,0 +1,172 @@
+#ifndef jsc_task_hpp
+#define jsc_task_hpp
+
+// Coroutine support needs C++20; in earlier modes this header is empty
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define JSC_HAS_COROUTINES 1
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace jsc {
+
+template <typename result_type = void>
+struct task;
+
+namespace details {
+
+struct task_promise_base {
+  std::coroutine_handle<> continuation{std::noop_coroutine()};
+  std::exception_ptr error;
+
+  // Hands control straight back to the awaiting coroutine, so long chains of
+  // tasks that complete synchronously do not grow the stack
+  struct final_awaiter {
+    [[nodiscard]] inline bool await_ready() const noexcept { return false; }
+    template <typename promise_type>
+    [[nodiscard]] inline std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<promise_type> handle) const noexcept {
+      return handle.promise().continuation;
+    }
+    inline void await_resume() const noexcept {}
+  };
+
+  [[nodiscard]] inline std::suspend_always initial_suspend() const noexcept {
+    return {};
+  }
+  [[nodiscard]] inline final_awaiter final_suspend() const noexcept {
+    return {};
+  }
+  inline void unhandled_exception() noexcept {
+    error = std::current_exception();
+  }
+
+ protected:
+  inline void rethrow() const {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+};
+
+template <typename result_type>
+struct task_promise : task_promise_base {
+  std::optional<result_type> result;
+
+  [[nodiscard]] task<result_type> get_return_object() noexcept;
+
+  template <typename val_type>
+  inline void return_value(val_type&& val) {
+    result.emplace(std::forward<val_type>(val));
+  }
+
+  [[nodiscard]] inline result_type take() {
+    rethrow();
+    return std::move(*result);
+  }
+};
+
+template <>
+struct task_promise<void> : task_promise_base {
+  [[nodiscard]] task<void> get_return_object() noexcept;
+
+  inline void return_void() const noexcept {}
+
+  inline void take() const { rethrow(); }
+};
+
+}  // namespace details
+
+// Lazily started coroutine, run when it is first awaited. Exceptions thrown in
+// the body are rethrown to the awaiting coroutine.
+template <typename result_type>
+struct [[nodiscard]] task {
+  using promise_type = details::task_promise<result_type>;
+  using handle_type = std::coroutine_handle<promise_type>;
+
+  inline task(task&& other) noexcept
+      : _handle{std::exchange(other._handle, nullptr)} {}
+  inline task& operator=(task&& other) noexcept {
+    if (this != &other) {
+      if (_handle) {
+        _handle.destroy();
+      }
+      _handle = std::exchange(other._handle, nullptr);
+    }
+    return *this;
+  }
+  inline ~task() {
+    if (_handle) {
+      _handle.destroy();
+    }
+  }
+
+  task(const task&) = delete;
+  task& operator=(const task&) = delete;
+
+  inline auto operator co_await() && noexcept {
+    struct awaiter {
+      handle_type handle;
+
+      [[nodiscard]] inline bool await_ready() const noexcept { return false; }
+      [[nodiscard]] inline std::coroutine_handle<> await_suspend(
+          std::coroutine_handle<> awaiting) const noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+      }
+      inline result_type await_resume() const {
+        return handle.promise().take();
+      }
+    };
+    return awaiter{_handle};
+  }
+
+ private:
+  friend promise_type;
+
+  handle_type _handle;
+
+  inline explicit task(handle_type handle) : _handle{handle} {}
+};
+
+namespace details {
+
+template <typename result_type>
+inline task<result_type>
+task_promise<result_type>::get_return_object() noexcept {
+  return task<result_type>{
+      std::coroutine_handle<task_promise>::from_promise(*this)};
+}
+
+inline task<void> task_promise<void>::get_return_object() noexcept {
+  return task<void>{std::coroutine_handle<task_promise>::from_promise(*this)};
+}
+
+// Eagerly started coroutine that nobody awaits; it frees itself on completion
+struct detached {
+  struct promise_type {
+    [[nodiscard]] inline detached get_return_object() const noexcept {
+      return {};
+    }
+    [[nodiscard]] inline std::suspend_never initial_suspend() const noexcept {
+      return {};
+    }
+    [[nodiscard]] inline std::suspend_never final_suspend() const noexcept {
+      return {};
+    }
+    inline void return_void() const noexcept {}
+    [[noreturn]] inline void unhandled_exception() const noexcept {
+      std::terminate();
+    }
+  };
+};
+
+}  // namespace details
+
+}  // namespace jsc
+
+#endif  // JSC_HAS_COROUTINES
+
+#endif  // jsc_task_hpp
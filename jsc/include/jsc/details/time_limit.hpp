@@ -0,0 +1,73 @@
+#ifndef jsc_time_limit_hpp
+#define jsc_time_limit_hpp
+
+#include <JavaScriptCore/JavaScriptCore.h>
+#include <chrono>
+
+// Exported by JavaScriptCore but declared only in its private headers
+extern "C" {
+typedef bool (*JSShouldTerminateCallback)(JSContextRef ctx, void* context);
+JS_EXPORT void JSContextGroupSetExecutionTimeLimit(
+    JSContextGroupRef group, double limit, JSShouldTerminateCallback callback,
+    void* context);
+JS_EXPORT void JSContextGroupClearExecutionTimeLimit(JSContextGroupRef group);
+}
+
+namespace jsc {
+
+struct context;
+
+// The engine keeps one time limit per context_group. While a scope is alive,
+// every call into the engine on a context of ctx's group, such as
+// eval_script() or object::call(), is stopped once it runs longer than limit
+// and reported as execution_terminated. The group gets back its previous
+// limit when the scope ends, whichever context or wrapper had set it, so
+// scopes on one group must nest rather than overlap.
+struct time_limit {
+  time_limit(context& ctx, std::chrono::duration<double> limit);
+  ~time_limit();
+
+  time_limit(const time_limit&) = delete;
+  time_limit& operator=(const time_limit&) = delete;
+
+ private:
+  JSContextGroupRef _group;
+  double _previous;
+};
+
+namespace details {
+
+// Set on the thread whose script the engine stopped for its time limit, until
+// the outermost call into the engine returns. Outside of any engine_entry it
+// is stale, and raise() discards it.
+inline thread_local bool termination_pending{false};
+// What the stopped call was reported with. Native callbacks rethrow it, so the
+// scripts that called them stop as well.
+inline thread_local JSValueRef termination_exception{nullptr};
+inline thread_local unsigned engine_depth{0};
+
+// Marks a call into the engine from C++, for as long as it runs and its
+// failure is reported
+struct engine_entry {
+  inline engine_entry() { engine_depth++; }
+  inline ~engine_entry() {
+    if (--engine_depth == 0) {
+      termination_pending = false;
+      termination_exception = nullptr;
+    }
+  }
+
+  engine_entry(const engine_entry&) = delete;
+  engine_entry& operator=(const engine_entry&) = delete;
+};
+
+// Sets the limit of group in seconds, zero or less clearing it, and returns
+// the limit it replaces. Groups are not retained: whoever sets a limit clears
+// it while the group is still alive, as context and time_limit do.
+double exchange_time_limit(JSContextGroupRef group, double limit);
+
+}  // namespace details
+
+}  // namespace jsc
+
+#endif  // jsc_time_limit_hpp
@@ -0,0 +1,73 @@
+#ifndef jsc_typed_array_hpp
+#define jsc_typed_array_hpp
+
+#include <JavaScriptCore/JavaScriptCore.h>
+#include <cstdint>
+#include <type_traits>
+
+namespace jsc {
+
+template <typename elem_type>
+struct typed_array_kind;
+
+template <>
+struct typed_array_kind<int8_t> {
+  static constexpr JSTypedArrayType type{kJSTypedArrayTypeInt8Array};
+};
+template <>
+struct typed_array_kind<uint8_t> {
+  static constexpr JSTypedArrayType type{kJSTypedArrayTypeUint8Array};
+};
+template <>
+struct typed_array_kind<int16_t> {
+  static constexpr JSTypedArrayType type{kJSTypedArrayTypeInt16Array};
+};
+template <>
+struct typed_array_kind<uint16_t> {
+  static constexpr JSTypedArrayType type{kJSTypedArrayTypeUint16Array};
+};
+template <>
+struct typed_array_kind<int32_t> {
+  static constexpr JSTypedArrayType type{kJSTypedArrayTypeInt32Array};
+};
+template <>
+struct typed_array_kind<uint32_t> {
+  static constexpr JSTypedArrayType type{kJSTypedArrayTypeUint32Array};
+};
+template <>
+struct typed_array_kind<float> {
+  static constexpr JSTypedArrayType type{kJSTypedArrayTypeFloat32Array};
+};
+template <>
+struct typed_array_kind<double> {
+  static constexpr JSTypedArrayType type{kJSTypedArrayTypeFloat64Array};
+};
+
+template <typename elem_type>
+static constexpr bool is_typed_array_element{
+    std::is_same_v<elem_type, int8_t> || std::is_same_v<elem_type, uint8_t> ||
+    std::is_same_v<elem_type, int16_t> || std::is_same_v<elem_type, uint16_t> ||
+    std::is_same_v<elem_type, int32_t> || std::is_same_v<elem_type, uint32_t> ||
+    std::is_same_v<elem_type, float> || std::is_same_v<elem_type, double>};
+
+template <typename elem_type>
+static constexpr JSTypedArrayType typed_array_type_for{
+    typed_array_kind<elem_type>::type};
+
+// Non-owning view of the elements behind a typed array or ArrayBuffer. It stays
+// valid while the JS object is alive and its buffer is not detached.
+template <typename elem_type>
+struct typed_array_view {
+  elem_type* data;
+  size_t size;
+
+  [[nodiscard]] inline elem_type* begin() const noexcept { return data; }
+  [[nodiscard]] inline elem_type* end() const noexcept { return data + size; }
+  [[nodiscard]] inline elem_type& operator[](size_t i) const noexcept {
+    return data[i];
+  }
+};
+
+}  // namespace jsc
+
+#endif  // jsc_typed_array_hpp
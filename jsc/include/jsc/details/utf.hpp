@@ -0,0 +1,136 @@
+#ifndef jsc_utf_hpp
+#define jsc_utf_hpp
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace jsc::details {
+
+// Appends the UTF-16 form of str to out, replacing malformed input with
+// U+FFFD.
+inline void append_utf16(std::string_view str, std::u16string& out) {
+  out.reserve(out.size() + str.size());
+  for (size_t i{0}; i < str.size();) {
+    const auto c{static_cast<uint8_t>(str[i])};
+    if (c < 0x80) {
+      out.push_back(static_cast<char16_t>(c));
+      i++;
+      continue;
+    }
+
+    size_t length;
+    char32_t code_point;
+    if ((c & 0xE0) == 0xC0) {
+      length = 2;
+      code_point = c & 0x1F;
+    } else if ((c & 0xF0) == 0xE0) {
+      length = 3;
+      code_point = c & 0x0F;
+    } else if ((c & 0xF8) == 0xF0) {
+      length = 4;
+      code_point = c & 0x07;
+    } else {
+      out.push_back(u'\uFFFD');
+      i++;
+      continue;
+    }
+
+    size_t read{1};
+    for (; read < length && i + read < str.size(); read++) {
+      const auto next{static_cast<uint8_t>(str[i + read])};
+      if ((next & 0xC0) != 0x80) {
+        break;
+      }
+      code_point = (code_point << 6) | (next & 0x3F);
+    }
+    i += read;
+
+    if (read < length || code_point > 0x10FFFF ||
+        (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+      out.push_back(u'\uFFFD');
+    } else if (code_point >= 0x10000) {
+      code_point -= 0x10000;
+      out.push_back(static_cast<char16_t>(0xD800 + (code_point >> 10)));
+      out.push_back(static_cast<char16_t>(0xDC00 + (code_point & 0x3FF)));
+    } else {
+      out.push_back(static_cast<char16_t>(code_point));
+    }
+  }
+}
+
+[[nodiscard]] inline bool is_ascii(std::u16string_view str) noexcept {
+  // Branch-free reduction, so that the loop vectorizes
+  char16_t bits{0};
+  for (const auto c : str) {
+    bits |= c;
+  }
+  return bits < 0x80;
+}
+
+[[nodiscard]] inline bool is_high_surrogate(char16_t c) noexcept {
+  return c >= 0xD800 && c <= 0xDBFF;
+}
+[[nodiscard]] inline bool is_low_surrogate(char16_t c) noexcept {
+  return c >= 0xDC00 && c <= 0xDFFF;
+}
+
+// Appends the UTF-8 form of str to out with a single allocation, replacing
+// unpaired surrogates with U+FFFD.
+inline void append_utf8(std::u16string_view str, std::string& out) {
+  const auto start{out.size()};
+  if (is_ascii(str)) {
+    out.resize(start + str.size());
+    auto dest{out.data() + start};
+    for (size_t i{0}; i < str.size(); i++) {
+      dest[i] = static_cast<char>(str[i]);
+    }
+    return;
+  }
+
+  size_t length{0};
+  for (size_t i{0}; i < str.size(); i++) {
+    const auto c{str[i]};
+    if (c < 0x80) {
+      length += 1;
+    } else if (c < 0x800) {
+      length += 2;
+    } else if (is_high_surrogate(c) && i + 1 < str.size() &&
+               is_low_surrogate(str[i + 1])) {
+      length += 4;
+      i++;
+    } else {
+      length += 3;
+    }
+  }
+
+  out.resize(start + length);
+  auto dest{reinterpret_cast<uint8_t*>(out.data() + start)};
+  for (size_t i{0}; i < str.size(); i++) {
+    char32_t c{str[i]};
+    if (c < 0x80) {
+      *dest++ = static_cast<uint8_t>(c);
+    } else if (c < 0x800) {
+      *dest++ = static_cast<uint8_t>(0xC0 | (c >> 6));
+      *dest++ = static_cast<uint8_t>(0x80 | (c & 0x3F));
+    } else if (is_high_surrogate(str[i]) && i + 1 < str.size() &&
+               is_low_surrogate(str[i + 1])) {
+      c = 0x10000 + ((c - 0xD800) << 10) + (str[++i] - 0xDC00);
+      *dest++ = static_cast<uint8_t>(0xF0 | (c >> 18));
+      *dest++ = static_cast<uint8_t>(0x80 | ((c >> 12) & 0x3F));
+      *dest++ = static_cast<uint8_t>(0x80 | ((c >> 6) & 0x3F));
+      *dest++ = static_cast<uint8_t>(0x80 | (c & 0x3F));
+    } else {
+      if (is_high_surrogate(str[i]) || is_low_surrogate(str[i])) {
+        c = 0xFFFD;
+      }
+      *dest++ = static_cast<uint8_t>(0xE0 | (c >> 12));
+      *dest++ = static_cast<uint8_t>(0x80 | ((c >> 6) & 0x3F));
+      *dest++ = static_cast<uint8_t>(0x80 | (c & 0x3F));
+    }
+  }
+}
+
+}  // namespace jsc::details
+
+#endif  // jsc_utf_hpp
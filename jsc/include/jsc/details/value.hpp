@@ -13,14 +13,25 @@ static constexpr tag_undefined undefined{};
 static constexpr tag_null null{};
 
 struct context;
+struct handle_scope;
 struct object;
 
+namespace details {
+struct coroutine_bridge;
+}
+
 struct value {
+  friend context;
+  friend handle_scope;
+  friend details::coroutine_bridge;
+
   value(context& ctx, JSValueRef ref);
   ~value();
 
   value(const value& val);
   value& operator=(const value& val);
+  value(value&& val) noexcept;
+  value& operator=(value&& val) noexcept;
 
   [[nodiscard]] bool is_undefined() const;
   [[nodiscard]] bool is_null() const;
@@ -32,14 +43,33 @@ struct value {
   [[nodiscard]] bool to_boolean() const;
   [[nodiscard]] double to_number() const;
   [[nodiscard]] std::string to_string() const;
+  // Reuses the capacity of out
+  void to_string(std::string& out) const;
+
+  // Serialized by the engine's JSON.stringify, indenting nested levels by
+  // indent spaces; values JSON cannot represent, like undefined, give an empty
+  // string. The second form reuses the capacity of out.
+  [[nodiscard]] std::string to_json(unsigned int indent = 0) const;
+  void to_json(std::string& out, unsigned int indent = 0) const;
 
   [[nodiscard]] object to_object() const;
 
+  // Converts through jsc::convert, e.g. val.as<std::vector<point>>() for a
+  // struct with declared jsc::fields; conversion errors are reported like
+  // other engine exceptions
+  template <typename type>
+  [[nodiscard]] type as() const;
+
   [[nodiscard]] inline JSValueRef ref() const { return _ref; }
 
  private:
   context* _ctx;
   JSValueRef _ref;
+  // Whether this wrapper holds its own protection, as opposed to being rooted
+  // by a handle_scope
+  bool _owned;
+
+  void own();
 };
 
 }  // namespace jsc
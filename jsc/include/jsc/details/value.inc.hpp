@@ -0,0 +1,17 @@
+#ifndef jsc_value_inc
+#define jsc_value_inc
+
+#include "context.hpp"
+
+namespace jsc {
+
+template <typename type>
+inline type value::as() const {
+  return _ctx->try_throwable([this](auto exception) {
+    return convert<type>::from(_ctx->_ref, _ref, exception);
+  });
+}
+
+}  // namespace jsc
+
+#endif  // jsc_value_inc
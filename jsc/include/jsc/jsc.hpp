@@ -4,11 +4,30 @@
 #ifndef jsc_hpp
 #define jsc_hpp
 
+#include "details/class_binding.hpp"
+#include "details/clone.hpp"
 #include "details/context.hpp"
+#include "details/context_pool.hpp"
+#include "details/convert.hpp"
+#include "details/coroutine.hpp"
+#include "details/error.hpp"
+#include "details/event_loop.hpp"
+#include "details/fields.hpp"
+#include "details/handle_scope.hpp"
+#include "details/instrument.hpp"
+#include "details/json.hpp"
+#include "details/key.hpp"
+#include "details/memory.hpp"
+#include "details/native.hpp"
 #include "details/object.hpp"
+#include "details/profiler.hpp"
 #include "details/property.hpp"
+#include "details/script.hpp"
+#include "details/time_limit.hpp"
+#include "details/typed_array.hpp"
 #include "details/value.hpp"
 
 #include "details/object.inc.hpp"
+#include "details/value.inc.hpp"
 
 #endif  // jsc_hpp
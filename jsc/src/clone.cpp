@@ -0,0 +1,642 @@
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "context.hpp"
+#include "object.inc.hpp"
+
+namespace jsc {
+
+namespace {
+
+enum class clone_tag : uint8_t {
+  undefined,
+  null,
+  boolean_false,
+  boolean_true,
+  int32,
+  number,
+  string,
+  array,
+  object,
+  array_buffer,
+  shared_array_buffer,
+  typed_array,
+  // Index of an object written earlier, for shared references and cycles
+  reference,
+  // A property name written for the first time, or the index of an earlier one
+  key,
+  key_reference
+};
+
+// Deeper graphs are reported as errors rather than overflowing the native
+// stack, in the writer and for crafted buffers in the reader
+constexpr unsigned int max_depth{512};
+
+// Views the reader can rebuild; types added to the engine later are not
+[[nodiscard]] inline bool is_cloneable_view(unsigned int type) {
+  return type <= kJSTypedArrayTypeFloat64Array;
+}
+
+// The index a property name stands for in an array: digits without leading
+// zeros, below 2^32 - 1
+[[nodiscard]] std::optional<uint32_t> array_index(JSStringRef name) {
+  const auto length{JSStringGetLength(name)};
+  const auto chars{JSStringGetCharactersPtr(name)};
+  if (length == 0 || length > 10 || (length > 1 && chars[0] == u'0')) {
+    return std::nullopt;
+  }
+  uint64_t index{0};
+  for (size_t i{0}; i < length; i++) {
+    if (chars[i] < u'0' || chars[i] > u'9') {
+      return std::nullopt;
+    }
+    index = index * 10 + (chars[i] - u'0');
+  }
+  if (index >= UINT32_MAX) {
+    return std::nullopt;
+  }
+  return static_cast<uint32_t>(index);
+}
+
+// Maps the data pointer of every live shared ArrayBuffer to its owner, so
+// serialize() can tell them apart from buffers owned by the engine
+std::mutex shared_mutex;
+std::unordered_map<const void*, std::weak_ptr<details::shared_bytes>>
+    shared_registry;
+
+[[nodiscard]] std::shared_ptr<details::shared_bytes> find_shared(
+    const void* data) {
+  const std::lock_guard<std::mutex> lock{shared_mutex};
+  const auto it{shared_registry.find(data)};
+  return it == shared_registry.end() ? nullptr : it->second.lock();
+}
+
+[[nodiscard]] JSObjectRef make_shared_array_buffer(
+    JSContextRef ctx, std::shared_ptr<details::shared_bytes> bytes,
+    JSValueRef* exception) {
+  const auto data{bytes->data.get()};
+  const auto size{bytes->size};
+  // Handed to the engine only once it has made the buffer
+  auto holder{std::make_unique<std::shared_ptr<details::shared_bytes>>(
+      std::move(bytes))};
+  const auto result{JSObjectMakeArrayBufferWithBytesNoCopy(
+      ctx, data, size,
+      [](void*, void* holder) {
+        delete static_cast<std::shared_ptr<details::shared_bytes>*>(holder);
+      },
+      holder.get(), exception)};
+  if (result != nullptr) {
+    holder.release();
+  }
+  return result;
+}
+
+struct clone_writer {
+  JSContextRef ctx;
+  clone_buffer& out;
+  std::optional<std::string> error;
+  JSValueRef thrown{nullptr};
+
+  inline clone_writer(JSContextRef ctx, clone_buffer& out)
+      : ctx{ctx}, out{out} {}
+  // Objects are protected while the graph is walked, as getters can run
+  // scripts that detach them
+  inline ~clone_writer() {
+    for (const auto& [obj, index] : _objects) {
+      details::count(details::counter::unprotect);
+      JSValueUnprotect(ctx, obj);
+    }
+  }
+
+  clone_writer(const clone_writer&) = delete;
+  clone_writer& operator=(const clone_writer&) = delete;
+
+  bool write(JSValueRef val) {
+    if (_depth == max_depth) {
+      return fail("Object graph is nested too deeply");
+    }
+    _depth++;
+    const auto ok{write_value(val)};
+    _depth--;
+    return ok;
+  }
+
+ private:
+  std::unordered_map<JSObjectRef, uint32_t> _objects;
+  // Views into _key_storage, which never moves its strings
+  std::unordered_map<std::u16string_view, uint32_t> _keys;
+  std::deque<std::u16string> _key_storage;
+  unsigned int _depth{0};
+
+  bool write_value(JSValueRef val) {
+    switch (JSValueGetType(ctx, val)) {
+      case kJSTypeUndefined:
+        put(clone_tag::undefined);
+        return true;
+      case kJSTypeNull:
+        put(clone_tag::null);
+        return true;
+      case kJSTypeBoolean:
+        put(JSValueToBoolean(ctx, val) ? clone_tag::boolean_true
+                                       : clone_tag::boolean_false);
+        return true;
+      case kJSTypeNumber:
+        write_number(JSValueToNumber(ctx, val, nullptr));
+        return true;
+      case kJSTypeString: {
+        const details::string_wrapper str{
+            JSValueToStringCopy(ctx, val, nullptr)};
+        put(clone_tag::string);
+        write_string(str.view());
+        return true;
+      }
+      case kJSTypeObject:
+        return write_object(JSValueToObject(ctx, val, nullptr));
+      case kJSTypeSymbol:
+        return fail("Symbol values cannot be cloned");
+      default:
+        return fail("Values of this type, e.g. BigInt, cannot be cloned");
+    }
+  }
+
+  inline bool fail(std::string message) {
+    error = std::move(message);
+    return false;
+  }
+
+  inline void put(const void* data, size_t size) {
+    if (size == 0) {
+      return;
+    }
+    const auto offset{out.data.size()};
+    out.data.resize(offset + size);
+    std::memcpy(out.data.data() + offset, data, size);
+  }
+  template <typename pod_type>
+  inline void put(pod_type val) {
+    put(&val, sizeof(val));
+  }
+
+  inline void write_number(double num) {
+    if (num >= INT32_MIN && num <= INT32_MAX &&
+        static_cast<int32_t>(num) == num && !(num == 0 && std::signbit(num))) {
+      put(clone_tag::int32);
+      put(static_cast<int32_t>(num));
+    } else {
+      put(clone_tag::number);
+      put(num);
+    }
+  }
+
+  // Code units are 2-aligned so the reader can hand them to the engine as is
+  inline void write_string(std::u16string_view str) {
+    put(static_cast<uint32_t>(str.size()));
+    if (out.data.size() % 2 != 0) {
+      out.data.push_back(0);
+    }
+    put(str.data(), str.size() * sizeof(char16_t));
+  }
+
+  inline void write_key(JSStringRef name) {
+    const std::u16string_view str{
+        reinterpret_cast<const char16_t*>(JSStringGetCharactersPtr(name)),
+        JSStringGetLength(name)};
+    const auto it{_keys.find(str)};
+    if (it != _keys.end()) {
+      put(clone_tag::key_reference);
+      put(it->second);
+      return;
+    }
+    _keys.emplace(_key_storage.emplace_back(str),
+                  static_cast<uint32_t>(_keys.size()));
+    put(clone_tag::key);
+    write_string(str);
+  }
+
+  bool write_object(JSObjectRef obj) {
+    const auto [it, inserted] =
+        _objects.emplace(obj, static_cast<uint32_t>(_objects.size()));
+    if (!inserted) {
+      put(clone_tag::reference);
+      put(it->second);
+      return true;
+    }
+    details::count(details::counter::protect);
+    JSValueProtect(ctx, obj);
+
+    if (JSObjectIsFunction(ctx, obj)) {
+      return fail("Functions cannot be cloned");
+    }
+    const auto type{JSValueGetTypedArrayType(ctx, obj, nullptr)};
+    if (type == kJSTypedArrayTypeArrayBuffer) {
+      write_array_buffer(obj);
+      return true;
+    }
+    if (type != kJSTypedArrayTypeNone) {
+      if (!is_cloneable_view(type)) {
+        return fail("This typed array type cannot be cloned");
+      }
+      put(clone_tag::typed_array);
+      put(static_cast<uint8_t>(type));
+      put(static_cast<uint64_t>(
+          JSObjectGetTypedArrayByteOffset(ctx, obj, nullptr)));
+      put(static_cast<uint64_t>(
+          JSObjectGetTypedArrayLength(ctx, obj, nullptr)));
+      return write_object(JSObjectGetTypedArrayBuffer(ctx, obj, nullptr));
+    }
+    if (JSValueIsArray(ctx, obj)) {
+      return write_array(obj);
+    }
+    return write_plain(obj);
+  }
+
+  inline void write_array_buffer(JSObjectRef obj) {
+    const auto data{JSObjectGetArrayBufferBytesPtr(ctx, obj, nullptr)};
+    const auto size{JSObjectGetArrayBufferByteLength(ctx, obj, nullptr)};
+    auto shared{find_shared(data)};
+    if (shared != nullptr) {
+      put(clone_tag::shared_array_buffer);
+      put(static_cast<uint32_t>(out.shared.size()));
+      out.shared.push_back(std::move(shared));
+    } else {
+      put(clone_tag::array_buffer);
+      put(static_cast<uint64_t>(size));
+      put(data, size);
+    }
+  }
+
+  bool write_array(JSObjectRef obj) {
+    JSValueRef exception{nullptr};
+    const auto length{JSValueToNumber(
+        ctx,
+        JSObjectGetProperty(ctx, obj, JSC_KEY("length").managed_ref(),
+                            &exception),
+        &exception)};
+    if (exception != nullptr) {
+      thrown = exception;
+      return false;
+    }
+    const auto count{details::number_cast<uint32_t>(length)};
+    // Only the elements present are written, as a sparse array can be far
+    // longer than its contents
+    std::vector<uint32_t> indices;
+    const auto names{JSObjectCopyPropertyNames(ctx, obj)};
+    const auto name_count{JSPropertyNameArrayGetCount(names)};
+    for (size_t i{0}; i < name_count; i++) {
+      const auto index{
+          array_index(JSPropertyNameArrayGetNameAtIndex(names, i))};
+      if (index.has_value() && *index < count) {
+        indices.push_back(*index);
+      }
+    }
+    JSPropertyNameArrayRelease(names);
+    put(clone_tag::array);
+    put(count);
+    put(static_cast<uint32_t>(indices.size()));
+    for (const auto index : indices) {
+      put(index);
+      const auto elem{JSObjectGetPropertyAtIndex(ctx, obj, index, &exception)};
+      if (exception != nullptr) {
+        thrown = exception;
+        return false;
+      }
+      if (!write(elem)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool write_plain(JSObjectRef obj) {
+    const auto names{JSObjectCopyPropertyNames(ctx, obj)};
+    const auto count{JSPropertyNameArrayGetCount(names)};
+    put(clone_tag::object);
+    put(static_cast<uint32_t>(count));
+    bool ok{true};
+    for (size_t i{0}; ok && i < count; i++) {
+      const auto name{JSPropertyNameArrayGetNameAtIndex(names, i)};
+      write_key(name);
+      JSValueRef exception{nullptr};
+      const auto prop{JSObjectGetProperty(ctx, obj, name, &exception)};
+      if (exception != nullptr) {
+        thrown = exception;
+        ok = false;
+      } else {
+        ok = write(prop);
+      }
+    }
+    JSPropertyNameArrayRelease(names);
+    return ok;
+  }
+};
+
+struct clone_reader {
+  JSContextRef ctx;
+  const clone_buffer& in;
+  JSValueRef thrown{nullptr};
+  const char* error{nullptr};
+
+  inline clone_reader(JSContextRef ctx, const clone_buffer& in)
+      : ctx{ctx}, in{in} {}
+  // Objects are protected until the whole graph is read, as the heap vector
+  // holding them is not seen by the collector
+  inline ~clone_reader() {
+    for (const auto obj : _objects) {
+      if (obj != nullptr) {
+        details::count(details::counter::unprotect);
+        JSValueUnprotect(ctx, obj);
+      }
+    }
+  }
+
+  clone_reader(const clone_reader&) = delete;
+  clone_reader& operator=(const clone_reader&) = delete;
+
+  // Returns nullptr on malformed input or if the engine throws
+  JSValueRef read() {
+    if (_depth == max_depth) {
+      error = "Clone buffer is nested too deeply";
+      return nullptr;
+    }
+    _depth++;
+    const auto result{read_value()};
+    _depth--;
+    return result;
+  }
+
+  [[nodiscard]] inline bool at_end() const { return _pos == in.data.size(); }
+
+ private:
+  size_t _pos{0};
+  std::vector<JSObjectRef> _objects;
+  std::vector<details::string_wrapper> _keys;
+  unsigned int _depth{0};
+
+  JSValueRef read_value() {
+    clone_tag tag;
+    if (!get(tag)) {
+      return nullptr;
+    }
+    switch (tag) {
+      case clone_tag::undefined:
+        return JSValueMakeUndefined(ctx);
+      case clone_tag::null:
+        return JSValueMakeNull(ctx);
+      case clone_tag::boolean_false:
+        return JSValueMakeBoolean(ctx, false);
+      case clone_tag::boolean_true:
+        return JSValueMakeBoolean(ctx, true);
+      case clone_tag::int32: {
+        int32_t num;
+        return get(num) ? JSValueMakeNumber(ctx, num) : nullptr;
+      }
+      case clone_tag::number: {
+        double num;
+        return get(num) ? JSValueMakeNumber(ctx, num) : nullptr;
+      }
+      case clone_tag::string: {
+        const auto str{read_string()};
+        return str == nullptr
+                   ? nullptr
+                   : JSValueMakeString(
+                         ctx, details::string_wrapper{str}.managed_ref());
+      }
+      case clone_tag::array:
+        return read_array();
+      case clone_tag::object:
+        return read_plain();
+      case clone_tag::array_buffer:
+        return read_array_buffer();
+      case clone_tag::shared_array_buffer:
+        return read_shared_array_buffer();
+      case clone_tag::typed_array:
+        return read_typed_array();
+      case clone_tag::reference: {
+        uint32_t index;
+        return get(index) && index < _objects.size() ? _objects[index]
+                                                     : nullptr;
+      }
+      default:
+        return nullptr;
+    }
+  }
+
+  inline bool get(void* data, size_t size) {
+    if (in.data.size() - _pos < size) {
+      return false;
+    }
+    std::memcpy(data, in.data.data() + _pos, size);
+    _pos += size;
+    return true;
+  }
+  template <typename pod_type>
+  inline bool get(pod_type& val) {
+    return get(&val, sizeof(val));
+  }
+
+  // New string ref owned by the caller, or nullptr
+  JSStringRef read_string() {
+    uint32_t length;
+    if (!get(length)) {
+      return nullptr;
+    }
+    _pos += _pos % 2;
+    if (_pos > in.data.size() ||
+        (in.data.size() - _pos) / sizeof(JSChar) < length) {
+      return nullptr;
+    }
+    const auto chars{reinterpret_cast<const JSChar*>(in.data.data() + _pos)};
+    _pos += length * sizeof(JSChar);
+    return JSStringCreateWithCharacters(chars, length);
+  }
+
+  JSStringRef read_key() {
+    clone_tag tag;
+    if (!get(tag)) {
+      return nullptr;
+    }
+    if (tag == clone_tag::key) {
+      const auto str{read_string()};
+      if (str != nullptr) {
+        _keys.emplace_back(str);
+      }
+      return str;
+    }
+    uint32_t index;
+    if (tag != clone_tag::key_reference || !get(index) ||
+        index >= _keys.size()) {
+      return nullptr;
+    }
+    return _keys[index].managed_ref();
+  }
+
+  inline void protect(JSObjectRef obj) {
+    details::count(details::counter::protect);
+    JSValueProtect(ctx, obj);
+  }
+
+  inline JSObjectRef add(JSObjectRef obj) {
+    if (obj != nullptr) {
+      protect(obj);
+      _objects.push_back(obj);
+    }
+    return obj;
+  }
+
+  JSValueRef read_array() {
+    uint32_t length;
+    uint32_t count;
+    if (!get(length) || !get(count)) {
+      return nullptr;
+    }
+    const auto result{add(JSObjectMakeArray(ctx, 0, nullptr, &thrown))};
+    if (result == nullptr) {
+      return nullptr;
+    }
+    for (uint32_t i{0}; i < count; i++) {
+      uint32_t index;
+      if (!get(index) || index >= length) {
+        return nullptr;
+      }
+      const auto elem{read()};
+      if (elem == nullptr) {
+        return nullptr;
+      }
+      JSObjectSetPropertyAtIndex(ctx, result, index, elem, nullptr);
+    }
+    // Restores the holes after the last element
+    JSObjectSetProperty(ctx, result, JSC_KEY("length").managed_ref(),
+                        JSValueMakeNumber(ctx, length),
+                        kJSPropertyAttributeNone, nullptr);
+    return result;
+  }
+
+  JSValueRef read_plain() {
+    uint32_t count;
+    if (!get(count)) {
+      return nullptr;
+    }
+    const auto result{add(JSObjectMake(ctx, nullptr, nullptr))};
+    for (uint32_t i{0}; i < count; i++) {
+      const auto name{read_key()};
+      const auto prop{name == nullptr ? nullptr : read()};
+      if (prop == nullptr) {
+        return nullptr;
+      }
+      JSObjectSetProperty(ctx, result, name, prop, kJSPropertyAttributeNone,
+                          nullptr);
+    }
+    return result;
+  }
+
+  JSValueRef read_array_buffer() {
+    uint64_t size;
+    if (!get(size) || in.data.size() - _pos < size) {
+      return nullptr;
+    }
+    // Handed to the engine only once it has made the buffer
+    std::unique_ptr<uint8_t[]> bytes{new uint8_t[size]};
+    std::memcpy(bytes.get(), in.data.data() + _pos, size);
+    _pos += size;
+    const auto result{JSObjectMakeArrayBufferWithBytesNoCopy(
+        ctx, bytes.get(), size,
+        [](void* bytes, void*) { delete[] static_cast<uint8_t*>(bytes); },
+        nullptr, &thrown)};
+    if (result != nullptr) {
+      bytes.release();
+    }
+    return add(result);
+  }
+
+  JSValueRef read_shared_array_buffer() {
+    uint32_t index;
+    if (!get(index) || index >= in.shared.size()) {
+      return nullptr;
+    }
+    return add(make_shared_array_buffer(ctx, in.shared[index], &thrown));
+  }
+
+  // The slot is taken before the buffer is read, to match the writer's order
+  JSValueRef read_typed_array() {
+    uint8_t type;
+    uint64_t offset;
+    uint64_t length;
+    if (!get(type) || !get(offset) || !get(length) ||
+        !is_cloneable_view(type)) {
+      return nullptr;
+    }
+    const auto slot{_objects.size()};
+    _objects.push_back(nullptr);
+    const auto buffer{read()};
+    if (buffer == nullptr || !JSValueIsObject(ctx, buffer)) {
+      return nullptr;
+    }
+    const auto result{JSObjectMakeTypedArrayWithArrayBufferAndOffset(
+        ctx, static_cast<JSTypedArrayType>(type),
+        JSValueToObject(ctx, buffer, nullptr), offset, length, &thrown)};
+    if (result != nullptr) {
+      protect(result);
+      _objects[slot] = result;
+    }
+    return result;
+  }
+};
+
+}  // namespace
+
+clone_buffer context::serialize(const value& val) {
+  // The writer runs getters without try_throwable; a termination in them is
+  // reported by the raise() below
+  const details::engine_entry entry;
+  clone_buffer result;
+  clone_writer writer{_ref, result};
+  if (writer.write(val.ref())) {
+    return result;
+  }
+  raise(writer.thrown != nullptr
+            ? writer.thrown
+            : error("DataCloneError: " + writer.error.value_or("")).ref());
+  return {};
+}
+
+value context::deserialize(const clone_buffer& buffer) {
+  clone_reader reader{_ref, buffer};
+  const auto result{reader.read()};
+  if (result != nullptr && reader.at_end()) {
+    return {*this, result};
+  }
+  raise(reader.thrown != nullptr
+            ? reader.thrown
+            : error(reader.error != nullptr ? reader.error
+                                            : "Malformed clone buffer")
+                  .ref());
+  return undefined();
+}
+
+object context::shared_array_buffer(size_t size) {
+  auto bytes{std::shared_ptr<details::shared_bytes>{
+      new details::shared_bytes{std::make_unique<uint8_t[]>(size), size},
+      [](details::shared_bytes* bytes) {
+        {
+          const std::lock_guard<std::mutex> lock{shared_mutex};
+          shared_registry.erase(bytes->data.get());
+        }
+        delete bytes;
+      }}};
+  {
+    const std::lock_guard<std::mutex> lock{shared_mutex};
+    shared_registry.emplace(bytes->data.get(), bytes);
+  }
+  return {*this, try_throwable([this, &bytes](auto exception) {
+            return make_shared_array_buffer(_ref, std::move(bytes), exception);
+          })};
+}
+
+}  // namespace jsc
@@ -1,18 +1,150 @@
 #include <utility>
 
 #include "context.hpp"
+#include "mapped_file.hpp"
+#include "object.inc.hpp"
 
 namespace jsc {
 
+value context::eval_script(const char* script, const std::string& source_url) {
+  return eval_script(jsc::script{script, source_url, 0});
+}
+
 value context::eval_script(const std::string& script,
                            const std::string& source_url) {
-  return {*this,
-          try_throwable(
-              [this, js_script{details::string_wrapper{script}},
-               js_url{details::string_wrapper{source_url}}](auto exception) {
-                return JSEvaluateScript(_ref, js_script.managed_ref(), nullptr,
-                                        js_url.managed_ref(), 0, exception);
-              })};
+  return eval_script(jsc::script{script, source_url, 0});
+}
+
+value context::eval_script(std::string_view script,
+                           const std::string& source_url) {
+  return eval_script(jsc::script{script, source_url, 0});
+}
+
+value context::eval_script(std::u16string_view script,
+                           const std::string& source_url) {
+  return eval_script(jsc::script{script, source_url, 0});
+}
+
+value context::eval_script(const script& script) {
+  const details::entry_scope entry{"eval_script", [&script] {
+    return details::entry_name(script.url_ref());
+  }};
+  return {*this, try_throwable([this, &script](auto exception) {
+            return JSEvaluateScript(_ref, script.source_ref(), nullptr,
+                                    script.url_ref(), script.starting_line(),
+                                    exception);
+          })};
+}
+
+value context::eval_file(const std::string& path) {
+  const details::mapped_file file{path};
+  if (!file.is_open()) {
+    raise(error("Cannot open file: " + path).ref());
+    return undefined();
+  }
+  if (file.is_null_terminated()) {
+    return eval_script(file.view().data(), path);
+  }
+  return eval_script(file.view(), path);
+}
+
+bool context::check_syntax(const script& script) {
+  return try_throwable([this, &script](auto exception) {
+    return JSCheckScriptSyntax(_ref, script.source_ref(), script.url_ref(),
+                               script.starting_line(), exception);
+  });
+}
+
+object context::compile(const script& script) {
+  return {*this, try_throwable([this, &script](auto exception) {
+            return JSObjectMakeFunction(_ref, nullptr, 0, nullptr,
+                                        script.source_ref(), script.url_ref(),
+                                        script.starting_line(), exception);
+          })};
+}
+
+void context::collect_garbage() {
+  _reported_since_collect = 0;
+  JSGarbageCollect(_ref);
+}
+
+void context::report_external_memory(size_t size) {
+  JSReportExtraMemoryCost(_ref, size);
+  _reported_since_collect += size;
+  if (_collect_every != 0 && _reported_since_collect >= _collect_every) {
+    collect_garbage();
+  }
+}
+
+memory_statistics context::memory_usage() const {
+  memory_statistics result{};
+  result.container_bytes =
+      details::container_bytes.load(std::memory_order_relaxed);
+  const auto stats{JSGetMemoryUsageStatistics(_ref)};
+  if (stats == nullptr) {
+    return result;
+  }
+  const auto read{[this, stats](const key& name) {
+    // Statistics the engine does not provide read as undefined, i.e. 0
+    return details::number_cast<size_t>(JSValueToNumber(
+        _ref, JSObjectGetProperty(_ref, stats, name.managed_ref(), nullptr),
+        nullptr));
+  }};
+  result.heap_size = read(JSC_KEY("heapSize"));
+  result.heap_capacity = read(JSC_KEY("heapCapacity"));
+  result.extra_memory = read(JSC_KEY("extraMemorySize"));
+  result.object_count = read(JSC_KEY("objectCount"));
+  result.protected_object_count = read(JSC_KEY("protectedObjectCount"));
+  return result;
+}
+
+value context::from_json(std::string_view json) {
+  return from_json_string(details::string_wrapper{json});
+}
+
+value context::from_json(std::u16string_view json) {
+  return from_json_string(details::string_wrapper{json});
+}
+
+value context::from_json_string(const details::string_wrapper& json) {
+  const auto result{JSValueMakeFromJSONString(_ref, json.managed_ref())};
+  if (result == nullptr) {
+    raise(error("JSON Parse error: Unable to parse JSON string").ref());
+    return undefined();
+  }
+  return {*this, result};
+}
+
+void context::raise(JSValueRef exception) {
+  if (details::engine_depth == 0) {
+    // Left over from engine calls made outside of try_throwable
+    details::termination_pending = false;
+    details::termination_exception = nullptr;
+  }
+  const auto terminated{details::termination_pending};
+  if (terminated) {
+    details::termination_exception = exception;
+  }
+  switch (_error_mode) {
+    case error_mode::store:
+      set_exception({*this, exception});
+      _terminated = terminated;
+      break;
+    case error_mode::exception: {
+      // Owned, as a handle_scope being unwound by the throw would release it
+      value thrown{*this, exception};
+      thrown.own();
+      std::string message;
+      const auto js_message{JSValueToStringCopy(_ref, exception, nullptr)};
+      if (js_message != nullptr) {
+        details::string_wrapper{js_message}.get(message);
+      }
+      if (terminated) {
+        throw execution_terminated{std::move(thrown), message};
+      }
+      throw js_error{std::move(thrown), message};
+    }
+  }
 }
 
 JSValueRef context::callback_class_call(JSContextRef ctx, JSObjectRef function,
@@ -22,8 +154,13 @@ JSValueRef context::callback_class_call(JSContextRef ctx, JSObjectRef function,
                                         JSValueRef* exception) {
   auto callback{
       static_cast<internal_callback_type*>(JSObjectGetPrivate(function))};
-  return (*callback)(ctx, function, this_object, argument_count, arguments,
-                     exception);
+  const details::entry_scope entry{"native", [ctx, function] {
+    return details::entry_name(ctx, function);
+  }};
+  return details::guard_callback(ctx, exception, JSValueRef{nullptr}, [&] {
+    return (*callback)(ctx, function, this_object, argument_count, arguments,
+                       exception);
+  });
 }
 
 }  // namespace jsc
@@ -0,0 +1,86 @@
+#include "context_pool.hpp"
+
+#include <stdexcept>
+
+namespace jsc {
+
+context_pool::context_pool(options opts) : _options{std::move(opts)} {
+  if (_options.shared_group) {
+    _group.emplace();
+  }
+  _idle.reserve(_options.size);
+  for (size_t i{0}; i < _options.size; i++) {
+    auto ctx{make_context()};
+    if (!bootstrap(*ctx)) {
+      const auto message{ctx->get_exception().to_string()};
+      throw std::runtime_error{"jsc::context_pool: bootstrap failed: " +
+                               message};
+    }
+    _idle.push_back(std::move(ctx));
+  }
+}
+
+context_pool::lease context_pool::acquire() {
+  std::unique_lock<std::mutex> lock{_mutex};
+  _released.wait(lock, [this] { return !_idle.empty(); });
+  return take(lock);
+}
+
+std::optional<context_pool::lease> context_pool::try_acquire(
+    std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock{_mutex};
+  if (!_released.wait_for(lock, timeout, [this] { return !_idle.empty(); })) {
+    return std::nullopt;
+  }
+  return take(lock);
+}
+
+size_t context_pool::available() const {
+  const std::lock_guard<std::mutex> lock{_mutex};
+  return _idle.size();
+}
+
+std::unique_ptr<context> context_pool::make_context() {
+  return _group.has_value() ? std::make_unique<context>(*_group)
+                            : std::make_unique<context>();
+}
+
+bool context_pool::bootstrap(context& ctx) {
+  if (!_options.bootstrap.empty()) {
+    ctx.eval_script(_options.bootstrap, _options.bootstrap_url);
+  }
+  return ctx.ok();
+}
+
+// The bootstrap already succeeded once, so a failure while resetting is not
+// reported; the context is returned to the pool with its exception cleared.
+void context_pool::release(std::unique_ptr<context> ctx) {
+  switch (_options.reset) {
+    case reset_policy::clear_exception:
+      break;
+    case reset_policy::rerun_bootstrap:
+      ctx->clear_exception();
+      bootstrap(*ctx);
+      break;
+    case reset_policy::recreate:
+      ctx = make_context();
+      bootstrap(*ctx);
+      break;
+  }
+  ctx->clear_exception();
+
+  {
+    const std::lock_guard<std::mutex> lock{_mutex};
+    _idle.push_back(std::move(ctx));
+  }
+  _released.notify_one();
+}
+
+context_pool::lease context_pool::take(std::unique_lock<std::mutex>& lock) {
+  auto ctx{std::move(_idle.back())};
+  _idle.pop_back();
+  lock.unlock();
+  return {*this, std::move(ctx)};
+}
+
+}  // namespace jsc
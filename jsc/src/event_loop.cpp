@@ -0,0 +1,267 @@
+#include "event_loop.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "object.inc.hpp"
+
+namespace jsc {
+
+event_loop::event_loop(context& ctx, size_t workers)
+    : _ctx{ctx}, _max_workers{std::max<size_t>(workers, 1)} {
+  const auto global{_ctx.root()};
+  global["setTimeout"] = _ctx.native([this](const native_call& call) {
+    return static_cast<double>(add_timer(call, false));
+  });
+  global["setInterval"] = _ctx.native([this](const native_call& call) {
+    return static_cast<double>(add_timer(call, true));
+  });
+  // Anything that is not a valid id, e.g. undefined, is ignored like in
+  // browsers
+  const auto clear{_ctx.native([this](const native_call& call) {
+    const auto id{call.get<double>(0)};
+    if (std::isfinite(id) && id >= 0 &&
+        id <= std::numeric_limits<unsigned int>::max()) {
+      clear_timer(static_cast<unsigned int>(id));
+    }
+  })};
+  global["clearTimeout"] = clear;
+  global["clearInterval"] = clear;
+}
+
+event_loop::~event_loop() {
+  {
+    const std::lock_guard<std::mutex> lock{_work_mutex};
+    _shutting_down = true;
+    _work.clear();
+  }
+  _work_ready.notify_all();
+  for (auto& worker : _workers) {
+    worker.join();
+  }
+
+  // Removed without raise(), which may throw
+  const auto global{JSContextGetGlobalObject(_ctx._ref)};
+  for (const auto name :
+       {"setTimeout", "setInterval", "clearTimeout", "clearInterval"}) {
+    JSObjectDeleteProperty(_ctx._ref, global,
+                           details::string_wrapper{name}.managed_ref(),
+                           nullptr);
+  }
+  for (const auto& [id, t] : _timers) {
+    release(t);
+  }
+  for (const auto& [id, d] : _deferred) {
+    _ctx.unprotect(d.resolve);
+    _ctx.unprotect(d.reject);
+  }
+}
+
+void event_loop::post(task t) {
+  if (_posted.push(std::move(t))) {
+    const std::lock_guard<std::mutex> lock{_wake_mutex};
+    _wake.notify_one();
+  }
+}
+
+void event_loop::run() {
+  _stopped.store(false, std::memory_order_release);
+  while (run_once() && !_stopped.load(std::memory_order_acquire)) {
+    wait();
+  }
+}
+
+bool event_loop::run_once() {
+  _posted.drain([this](task t) { _ready.push_back(std::move(t)); });
+  while (!_ready.empty() && !_stopped.load(std::memory_order_acquire)) {
+    const auto next{std::move(_ready.front())};
+    _ready.pop_front();
+    next(_ctx);
+  }
+  run_timers();
+  return alive();
+}
+
+void event_loop::stop() {
+  _stopped.store(true, std::memory_order_release);
+  const std::lock_guard<std::mutex> lock{_wake_mutex};
+  _wake.notify_one();
+}
+
+bool event_loop::alive() const {
+  return !_ready.empty() || !_posted.empty() || !_timers.empty() ||
+         !_deferred.empty();
+}
+
+unsigned int event_loop::add_timer(const native_call& call, bool repeat) {
+  const auto function{call.arg(0)};
+  if (!JSValueIsObject(call.ctx, function) ||
+      !JSObjectIsFunction(call.ctx, const_cast<JSObjectRef>(function))) {
+    call.throw_error("Timer callback is not a function");
+    return 0;
+  }
+  // Like browsers, a missing, negative or NaN delay means as soon as possible
+  const auto delay{call.size() > 1 ? call.get<double>(1) : 0.};
+  // An interval is at least 1ms, so that it cannot starve everything else
+  const auto interval{std::chrono::duration_cast<clock::duration>(
+      std::chrono::duration<double, std::milli>{std::max(
+          std::isfinite(delay) ? delay : 0., repeat ? 1. : 0.)})};
+
+  timer t{const_cast<JSObjectRef>(function), {}, interval, repeat};
+  if (call.size() > 2) {
+    t.args.assign(call.args.begin() + 2, call.args.end());
+  }
+  _ctx.protect(t.function);
+  for (const auto arg : t.args) {
+    _ctx.protect(arg);
+  }
+
+  const auto id{_next_id++};
+  _timers.emplace(id, std::move(t));
+  _schedule.push({clock::now() + interval, id});
+  return id;
+}
+
+// Entries left in _schedule for cleared timers are skipped when they come due
+void event_loop::clear_timer(unsigned int id) {
+  const auto it{_timers.find(id)};
+  if (it != _timers.end()) {
+    const auto t{std::move(it->second)};
+    _timers.erase(it);
+    release(t);
+  }
+}
+
+void event_loop::release(const timer& t) {
+  _ctx.unprotect(t.function);
+  for (const auto arg : t.args) {
+    _ctx.unprotect(arg);
+  }
+}
+
+// Only timers already due on entry run, so a callback that schedules a zero
+// delay timer cannot keep this pass going forever.
+void event_loop::run_timers() {
+  const auto now{clock::now()};
+  while (!_schedule.empty() && _schedule.top().due <= now &&
+         !_stopped.load(std::memory_order_acquire)) {
+    const auto id{_schedule.top().id};
+    _schedule.pop();
+    const auto it{_timers.find(id)};
+    if (it == _timers.end()) {
+      continue;
+    }
+
+    if (it->second.repeat) {
+      // The entry stays protected in _timers; a copy survives the callback
+      // clearing the interval or adding timers.
+      const auto t{it->second};
+      _schedule.push({now + t.interval, id});
+      call(t.function, t.args.data(), t.args.size());
+    } else {
+      const auto t{std::move(it->second)};
+      _timers.erase(it);
+      try {
+        call(t.function, t.args.data(), t.args.size());
+      } catch (...) {
+        release(t);
+        throw;
+      }
+      release(t);
+    }
+  }
+}
+
+void event_loop::wait() {
+  std::unique_lock<std::mutex> lock{_wake_mutex};
+  const auto woken{[this] {
+    return !_posted.empty() || _stopped.load(std::memory_order_acquire);
+  }};
+  if (!_ready.empty()) {
+    return;
+  }
+  if (_schedule.empty()) {
+    _wake.wait(lock, woken);
+  } else {
+    _wake.wait_until(lock, _schedule.top().due, woken);
+  }
+}
+
+object event_loop::deferred_promise(unsigned int& id) {
+  JSObjectRef resolve{nullptr};
+  JSObjectRef reject{nullptr};
+  const auto promise{_ctx.try_throwable([&](auto exception) {
+    return JSObjectMakeDeferredPromise(_ctx._ref, &resolve, &reject,
+                                       exception);
+  })};
+  if (promise != nullptr) {
+    _ctx.protect(resolve);
+    _ctx.protect(reject);
+    id = _next_id++;
+    _deferred.emplace(id, deferred{resolve, reject});
+  }
+  return {_ctx, promise};
+}
+
+void event_loop::settle(unsigned int id, JSValueRef result, bool rejected) {
+  const auto it{_deferred.find(id)};
+  if (it == _deferred.end()) {
+    return;
+  }
+  const auto d{it->second};
+  _deferred.erase(it);
+  try {
+    call(rejected ? d.reject : d.resolve, &result, 1);
+  } catch (...) {
+    _ctx.unprotect(d.resolve);
+    _ctx.unprotect(d.reject);
+    throw;
+  }
+  _ctx.unprotect(d.resolve);
+  _ctx.unprotect(d.reject);
+}
+
+void event_loop::reject_with(unsigned int id, const std::string& message) {
+  const auto js_message{convert<std::string>::to(_ctx._ref, message)};
+  settle(id, JSObjectMakeError(_ctx._ref, 1, &js_message, nullptr), true);
+}
+
+void event_loop::call(JSObjectRef function, const JSValueRef* args,
+                      size_t count) {
+  _ctx.try_throwable([&](auto exception) {
+    JSObjectCallAsFunction(_ctx._ref, function, nullptr, count, args,
+                           exception);
+  });
+}
+
+void event_loop::submit(std::function<void()> work) {
+  {
+    const std::lock_guard<std::mutex> lock{_work_mutex};
+    _work.push_back(std::move(work));
+  }
+  if (_workers.size() < _max_workers) {
+    _workers.emplace_back([this] { work_on(); });
+  } else {
+    _work_ready.notify_one();
+  }
+}
+
+void event_loop::work_on() {
+  while (true) {
+    std::function<void()> work;
+    {
+      std::unique_lock<std::mutex> lock{_work_mutex};
+      _work_ready.wait(lock,
+                       [this] { return _shutting_down || !_work.empty(); });
+      if (_shutting_down) {
+        return;
+      }
+      work = std::move(_work.front());
+      _work.pop_front();
+    }
+    work();
+  }
+}
+
+}  // namespace jsc
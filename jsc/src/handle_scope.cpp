@@ -0,0 +1,35 @@
+#include "handle_scope.hpp"
+
+#include <cassert>
+
+#include "context.hpp"
+
+namespace jsc {
+
+handle_scope::handle_scope(context& ctx)
+    : _ctx{ctx}, _ref{ctx._ref}, _parent{ctx._scope} {
+  JSGlobalContextRetain(_ref);
+  _ctx._scope = this;
+}
+
+handle_scope::~handle_scope() {
+  assert(_ctx._scope == this);
+  _ctx._scope = _parent;
+  for (const auto val : _rooted) {
+    details::count(details::counter::unprotect);
+    JSValueUnprotect(_ref, val);
+  }
+  JSGlobalContextRelease(_ref);
+}
+
+value handle_scope::escape(value val) const {
+  val.own();
+  return val;
+}
+
+object handle_scope::escape(object obj) const {
+  obj.own();
+  return obj;
+}
+
+}  // namespace jsc
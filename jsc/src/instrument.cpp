@@ -0,0 +1,71 @@
+#include "instrument.hpp"
+
+#include <unordered_map>
+
+#include "json.hpp"
+
+namespace jsc {
+
+namespace {
+
+// Spans that saw a recorder finish before it can be read or destroyed
+void wait_for_spans() {
+  while (details::spans_in_flight.load(std::memory_order_acquire) != 0) {
+    std::this_thread::yield();
+  }
+}
+
+}  // namespace
+
+void trace_recorder::start() {
+  const auto replaced{
+      details::active_recorder.exchange(this, std::memory_order_seq_cst)};
+  // Its own stop() will find it inactive and return right away
+  if (replaced != nullptr && replaced != this) {
+    wait_for_spans();
+  }
+}
+
+void trace_recorder::stop() {
+  auto expected{this};
+  if (details::active_recorder.compare_exchange_strong(
+          expected, nullptr, std::memory_order_seq_cst)) {
+    wait_for_spans();
+  }
+}
+
+void trace_recorder::json(std::string& out) const {
+  const auto micros{[](clock::duration duration) {
+    return std::chrono::duration<double, std::micro>{duration}.count();
+  }};
+  out.clear();
+  json_writer writer{out};
+  writer.begin_object().key("traceEvents").begin_array();
+  std::lock_guard lock{_mutex};
+  // Small stable ids instead of the platform's thread ids
+  std::unordered_map<std::thread::id, size_t> threads;
+  for (const auto& recorded : _spans) {
+    const auto tid{
+        threads.try_emplace(recorded.thread, threads.size() + 1).first->second};
+    writer.begin_object()
+        .field("name", recorded.name)
+        .field("cat", recorded.category)
+        .field("ph", "X")
+        .field("ts", micros(recorded.start - _origin))
+        .field("dur", micros(recorded.end - recorded.start))
+        .field("pid", 1)
+        .field("tid", tid)
+        .end_object();
+  }
+  writer.end_array().end_object();
+}
+
+void trace_recorder::record(const char* category, std::string name,
+                            clock::time_point start) {
+  const auto end{clock::now()};
+  std::lock_guard lock{_mutex};
+  _spans.push_back(
+      {category, std::move(name), start, end, std::this_thread::get_id()});
+}
+
+}  // namespace jsc
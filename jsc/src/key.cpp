@@ -0,0 +1,50 @@
+#include "key.hpp"
+
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace jsc {
+
+namespace {
+
+struct key_cache {
+  static constexpr size_t capacity{4096};
+
+  std::shared_mutex mutex;
+  // Owns the names viewed by the map keys
+  std::deque<std::string> names;
+  std::unordered_map<std::string_view, key> keys;
+};
+
+key_cache& global_key_cache() {
+  static key_cache cache;
+  return cache;
+}
+
+}  // namespace
+
+key key::intern(std::string_view name) {
+  auto& cache{global_key_cache()};
+  {
+    const std::shared_lock<std::shared_mutex> lock{cache.mutex};
+    const auto found{cache.keys.find(name)};
+    if (found != cache.keys.end()) {
+      return found->second;
+    }
+    if (cache.keys.size() >= key_cache::capacity) {
+      return std::string{name};
+    }
+  }
+
+  const std::unique_lock<std::shared_mutex> lock{cache.mutex};
+  const auto found{cache.keys.find(name)};
+  if (found != cache.keys.end()) {
+    return found->second;
+  }
+  const auto& stored{cache.names.emplace_back(name)};
+  return cache.keys.emplace(stored, key{stored}).first->second;
+}
+
+}  // namespace jsc
@@ -0,0 +1,41 @@
+#include "mapped_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace jsc::details {
+
+mapped_file::mapped_file(const std::string& path)
+    : _page_size{static_cast<size_t>(sysconf(_SC_PAGESIZE))} {
+  const auto fd{open(path.c_str(), O_RDONLY)};
+  if (fd < 0) {
+    return;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) == 0) {
+    _size = static_cast<size_t>(info.st_size);
+    if (_size == 0) {
+      _open = true;
+    } else {
+      const auto data{mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0)};
+      if (data != MAP_FAILED) {
+        _data = data;
+        _open = true;
+      } else {
+        _size = 0;
+      }
+    }
+  }
+  close(fd);
+}
+
+mapped_file::~mapped_file() {
+  if (_data != nullptr) {
+    munmap(_data, _size);
+  }
+}
+
+}  // namespace jsc::details
@@ -5,25 +5,69 @@
 
 namespace jsc {
 
-object::object(context& ctx, JSObjectRef ref) : _ctx{&ctx}, _ref{ref} {
-  _ctx->protect(_ref);
+object::object(context& ctx, JSObjectRef ref)
+    : _ctx{&ctx}, _ref{ref}, _owned{_ctx->root(_ref)} {}
+object::~object() {
+  if (_owned) {
+    _ctx->unprotect(_ref);
+  }
 }
 
-object::~object() { _ctx->unprotect(_ref); }
+object::object(const object& obj)
+    : _ctx{obj._ctx}, _ref{obj._ref}, _owned{_ctx->root(_ref)} {}
 
-object::object(const object& obj) : _ctx{obj._ctx}, _ref{obj._ref} {
-  _ctx->protect(_ref);
-}
+// A wrapper that owns its value keeps owning after assignment, so a
+// long-lived wrapper assigned inside a handle_scope is not rooted by it
 object& object::operator=(const object& obj) {
-  _ctx->unprotect(_ref);
-  _ctx = obj._ctx;
-  _ref = obj._ref;
-  _ctx->protect(_ref);
+  if (this != &obj) {
+    const auto was_owned{_owned};
+    if (_owned) {
+      _ctx->unprotect(_ref);
+    }
+    _ctx = obj._ctx;
+    _ref = obj._ref;
+    if (was_owned) {
+      _ctx->protect(_ref);
+    } else {
+      _owned = _ctx->root(_ref);
+    }
+  }
+  return *this;
+}
+
+object::object(object&& obj) noexcept
+    : _ctx{obj._ctx}, _ref{obj._ref}, _owned{obj._owned} {
+  obj._owned = false;
+}
+object& object::operator=(object&& obj) noexcept {
+  if (this != &obj) {
+    const auto was_owned{_owned};
+    if (_owned) {
+      _ctx->unprotect(_ref);
+    }
+    _ctx = obj._ctx;
+    _ref = obj._ref;
+    _owned = obj._owned;
+    obj._owned = false;
+    if (was_owned) {
+      own();
+    }
+  }
   return *this;
 }
 
-property<details::string_wrapper> object::operator[](
-    const std::string& name) const {
+void object::own() {
+  if (!_owned) {
+    _ctx->protect(_ref);
+    _owned = true;
+  }
+}
+
+property<key> object::operator[](const std::string& name) const {
+  return {*this, key::intern(name)};
+}
+
+property<key> object::operator[](const key& name) const {
   return {*this, name};
 }
 
@@ -35,18 +79,34 @@ bool object::is_function() const {
   return JSObjectIsFunction(_ctx->_ref, _ref);
 }
 
-bool object::has_property(const details::string_wrapper& name) const {
+JSTypedArrayType object::typed_array_type() const {
+  return _ctx->try_throwable([this](auto exception) {
+    return JSValueGetTypedArrayType(_ctx->_ref, _ref, exception);
+  });
+}
+
+typed_array_view<uint8_t> object::array_buffer_data() const {
+  assert(typed_array_type() == kJSTypedArrayTypeArrayBuffer);
+  return _ctx->try_throwable([this](auto exception) {
+    return typed_array_view<uint8_t>{
+        static_cast<uint8_t*>(
+            JSObjectGetArrayBufferBytesPtr(_ctx->_ref, _ref, exception)),
+        JSObjectGetArrayBufferByteLength(_ctx->_ref, _ref, exception)};
+  });
+}
+
+bool object::has_property(const key& name) const {
   return JSObjectHasProperty(_ctx->_ref, _ref, name.managed_ref());
 }
 
-bool object::remove_property(const details::string_wrapper& name) const {
+bool object::remove_property(const key& name) const {
   return _ctx->try_throwable([this, &name](auto exception) {
     return JSObjectDeleteProperty(_ctx->_ref, _ref, name.managed_ref(),
                                   exception);
   });
 }
 
-value object::get_property(const details::string_wrapper& name) const {
+value object::get_property(const key& name) const {
   return {*_ctx, _ctx->try_throwable([this, &name](auto exception) {
             return JSObjectGetProperty(_ctx->_ref, _ref, name.managed_ref(),
                                        exception);
@@ -60,7 +120,7 @@ value object::get_property(unsigned int index) const {
           })};
 }
 
-void object::set_property(const details::string_wrapper& name,
+void object::set_property(const key& name,
                           const value& val) const {
   _ctx->try_throwable([this, &name, &val](auto exception) {
     JSObjectSetProperty(_ctx->_ref, _ref, name.managed_ref(), val.ref(),
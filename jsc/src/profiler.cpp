@@ -0,0 +1,172 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+
+#include "key.hpp"
+#include "string.hpp"
+
+namespace jsc {
+
+void profiler::start() {
+  details::active_profiler = this;
+  if (_interval.count() > 0 && !_sampler.joinable()) {
+    _sampling = true;
+    _sampler = std::thread{[this] { sample(); }};
+  }
+}
+
+void profiler::stop() {
+  if (details::active_profiler == this) {
+    details::active_profiler = nullptr;
+  }
+  if (_sampler.joinable()) {
+    {
+      std::lock_guard lock{_mutex};
+      _sampling = false;
+    }
+    _wake.notify_one();
+    _sampler.join();
+  }
+}
+
+std::vector<profiler::entry> profiler::entries() const {
+  auto result{_entries};
+  const std::lock_guard lock{_mutex};
+  for (const auto& [index, count] : _samples) {
+    result[_nodes[index].name].samples += count;
+  }
+  std::sort(result.begin(), result.end(),
+            [](const auto& a, const auto& b) { return a.self > b.self; });
+  return result;
+}
+
+void profiler::folded(std::string& out) const {
+  out.clear();
+  const std::lock_guard lock{_mutex};
+  std::vector<size_t> path;
+  for (size_t index{1}; index < _nodes.size(); index++) {
+    size_t weight;
+    if (_interval.count() > 0) {
+      const auto found{_samples.find(index)};
+      weight = found == _samples.end() ? 0 : found->second;
+    } else {
+      weight = std::chrono::duration_cast<std::chrono::microseconds>(
+                   _nodes[index].self)
+                   .count();
+    }
+    if (weight == 0) {
+      continue;
+    }
+    path.clear();
+    for (auto at{index}; at != 0; at = _nodes[at].parent) {
+      path.push_back(at);
+    }
+    for (auto it{path.rbegin()}; it != path.rend(); ++it) {
+      if (it != path.rbegin()) {
+        out.push_back(';');
+      }
+      // Semicolons separate frames in the format
+      const auto& name{_entries[_nodes[*it].name].name};
+      const auto start{out.size()};
+      out.append(name);
+      std::replace(out.begin() + start, out.end(), ';', ',');
+    }
+    out.push_back(' ');
+    out.append(std::to_string(weight));
+    out.push_back('\n');
+  }
+}
+
+void profiler::enter(const std::string& name) {
+  const auto [name_it, new_name]{_ids.try_emplace(name, _entries.size())};
+  const auto id{name_it->second};
+  if (new_name) {
+    _entries.push_back({name_it->first, 0, {}, {}, 0});
+    _depth.push_back(0);
+  }
+  const auto parent{_stack.empty() ? 0 : _stack.back().node};
+  const auto [node_it, new_node]{
+      _nodes[parent].children.try_emplace(id, _nodes.size())};
+  const auto index{node_it->second};
+  if (new_node) {
+    _nodes.push_back({id, parent, {}, {}});
+  }
+  _entries[id].calls++;
+  _depth[id]++;
+  _stack.push_back({index, clock::now(), {}});
+  _current.store(index, std::memory_order_relaxed);
+}
+
+void profiler::leave() {
+  const auto current{_stack.back()};
+  _stack.pop_back();
+  const auto elapsed{clock::now() - current.start};
+  auto& info{_nodes[current.node]};
+  info.self += elapsed - current.nested;
+  _entries[info.name].self += elapsed - current.nested;
+  if (--_depth[info.name] == 0) {
+    _entries[info.name].total += elapsed;
+  }
+  if (_stack.empty()) {
+    _current.store(0, std::memory_order_relaxed);
+  } else {
+    _stack.back().nested += elapsed;
+    _current.store(_stack.back().node, std::memory_order_relaxed);
+  }
+}
+
+void profiler::sample() {
+  std::unique_lock lock{_mutex};
+  while (!_wake.wait_for(lock, _interval, [this] { return !_sampling; })) {
+    const auto index{_current.load(std::memory_order_relaxed)};
+    if (index != 0) {
+      _samples[index]++;
+    }
+  }
+}
+
+namespace details {
+
+std::string entry_name(JSStringRef url) {
+  JSStringRetain(url);
+  return string_wrapper{url}.get();
+}
+
+// Read through Object.getOwnPropertyDescriptor, so that a name defined with a
+// getter is not run on every profiled call; only a data property is used
+std::string entry_name(JSContextRef ctx, JSObjectRef function) {
+  const auto object_ctor{
+      JSObjectGetProperty(ctx, JSContextGetGlobalObject(ctx),
+                          JSC_KEY("Object").managed_ref(), nullptr)};
+  if (object_ctor == nullptr || !JSValueIsObject(ctx, object_ctor)) {
+    return "(native)";
+  }
+  const auto object_obj{JSValueToObject(ctx, object_ctor, nullptr)};
+  const auto describe{JSObjectGetProperty(
+      ctx, object_obj, JSC_KEY("getOwnPropertyDescriptor").managed_ref(),
+      nullptr)};
+  if (describe == nullptr || !JSValueIsObject(ctx, describe)) {
+    return "(native)";
+  }
+  const JSValueRef args[]{
+      function, JSValueMakeString(ctx, JSC_KEY("name").managed_ref())};
+  const auto descriptor{
+      JSObjectCallAsFunction(ctx, JSValueToObject(ctx, describe, nullptr),
+                             object_obj, 2, args, nullptr)};
+  if (descriptor == nullptr || !JSValueIsObject(ctx, descriptor)) {
+    return "(native)";
+  }
+  const auto name{JSObjectGetProperty(ctx,
+                                      JSValueToObject(ctx, descriptor, nullptr),
+                                      JSC_KEY("value").managed_ref(), nullptr)};
+  if (name == nullptr || !JSValueIsString(ctx, name)) {
+    return "(native)";
+  }
+  const auto result{
+      string_wrapper{JSValueToStringCopy(ctx, name, nullptr)}.get()};
+  return result.empty() ? "(anonymous)" : result;
+}
+
+}  // namespace details
+
+}  // namespace jsc
@@ -0,0 +1,48 @@
+#include "time_limit.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+#include "context.hpp"
+
+namespace jsc {
+
+time_limit::time_limit(context& ctx, std::chrono::duration<double> limit)
+    : _group{JSContextGetGroup(ctx._ref)} {
+  JSContextGroupRetain(_group);
+  _previous = details::exchange_time_limit(_group, limit.count());
+}
+
+time_limit::~time_limit() {
+  details::exchange_time_limit(_group, _previous);
+  JSContextGroupRelease(_group);
+}
+
+namespace details {
+
+double exchange_time_limit(JSContextGroupRef group, double limit) {
+  static std::mutex mutex;
+  static std::unordered_map<JSContextGroupRef, double> limits;
+  const std::lock_guard lock{mutex};
+  const auto found{limits.find(group)};
+  const auto previous{found == limits.end() ? 0 : found->second};
+  if (limit > 0) {
+    limits.insert_or_assign(group, limit);
+    // Called on the thread running the script, which is then terminated
+    JSContextGroupSetExecutionTimeLimit(
+        group, limit,
+        [](JSContextRef, void*) {
+          termination_pending = true;
+          return true;
+        },
+        nullptr);
+  } else if (found != limits.end()) {
+    limits.erase(found);
+    JSContextGroupClearExecutionTimeLimit(group);
+  }
+  return previous;
+}
+
+}  // namespace details
+
+}  // namespace jsc
@@ -6,22 +6,64 @@
 
 namespace jsc {
 
-value::value(context& ctx, JSValueRef ref) : _ctx{&ctx}, _ref{ref} {
-  _ctx->protect(_ref);
+value::value(context& ctx, JSValueRef ref)
+    : _ctx{&ctx}, _ref{ref}, _owned{_ctx->root(_ref)} {}
+value::~value() {
+  if (_owned) {
+    _ctx->unprotect(_ref);
+  }
 }
-value::~value() { _ctx->unprotect(_ref); }
 
-value::value(const value& val) : _ctx{val._ctx}, _ref{val._ref} {
-  _ctx->protect(_ref);
-}
+value::value(const value& val)
+    : _ctx{val._ctx}, _ref{val._ref}, _owned{_ctx->root(_ref)} {}
+
+// A wrapper that owns its value keeps owning after assignment, so a
+// long-lived wrapper assigned inside a handle_scope is not rooted by it
 value& value::operator=(const value& val) {
-  _ctx->unprotect(_ref);
-  _ctx = val._ctx;
-  _ref = val._ref;
-  _ctx->protect(_ref);
+  if (this != &val) {
+    const auto was_owned{_owned};
+    if (_owned) {
+      _ctx->unprotect(_ref);
+    }
+    _ctx = val._ctx;
+    _ref = val._ref;
+    if (was_owned) {
+      _ctx->protect(_ref);
+    } else {
+      _owned = _ctx->root(_ref);
+    }
+  }
   return *this;
 }
 
+value::value(value&& val) noexcept
+    : _ctx{val._ctx}, _ref{val._ref}, _owned{val._owned} {
+  val._owned = false;
+}
+value& value::operator=(value&& val) noexcept {
+  if (this != &val) {
+    const auto was_owned{_owned};
+    if (_owned) {
+      _ctx->unprotect(_ref);
+    }
+    _ctx = val._ctx;
+    _ref = val._ref;
+    _owned = val._owned;
+    val._owned = false;
+    if (was_owned) {
+      own();
+    }
+  }
+  return *this;
+}
+
+void value::own() {
+  if (!_owned) {
+    _ctx->protect(_ref);
+    _owned = true;
+  }
+}
+
 bool value::is_undefined() const {
   return JSValueIsUndefined(_ctx->_ref, _ref);
 }
@@ -38,10 +80,35 @@ double value::to_number() const {
   });
 }
 std::string value::to_string() const {
-  return _ctx->try_throwable([this](auto exception) {
-    return details::string_wrapper{
-        JSValueToStringCopy(_ctx->_ref, _ref, exception)}
-        .get();
+  std::string result;
+  to_string(result);
+  return result;
+}
+void value::to_string(std::string& out) const {
+  _ctx->try_throwable([this, &out](auto exception) {
+    const auto js_string{JSValueToStringCopy(_ctx->_ref, _ref, exception)};
+    if (js_string == nullptr) {
+      out.clear();
+    } else {
+      details::string_wrapper{js_string}.get(out);
+    }
+  });
+}
+
+std::string value::to_json(unsigned int indent) const {
+  std::string result;
+  to_json(result, indent);
+  return result;
+}
+void value::to_json(std::string& out, unsigned int indent) const {
+  _ctx->try_throwable([this, &out, indent](auto exception) {
+    const auto json{
+        JSValueCreateJSONString(_ctx->_ref, _ref, indent, exception)};
+    if (json == nullptr) {
+      out.clear();
+    } else {
+      details::string_wrapper{json}.get(out);
+    }
   });
 }
 
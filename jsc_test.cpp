@@ -1,11 +1,32 @@
 #include <chrono>
 #include <cmath>
-#include <fstream>
 #include <iostream>
-#include <sstream>
+#include <map>
+#include <optional>
 
 #include <jsc/jsc.hpp>
 
+struct point {
+  double x;
+  double y;
+
+  double length() const { return std::sqrt(x * x + y * y); }
+};
+
+template <>
+struct jsc::fields<point> {
+  static constexpr auto list{
+      std::make_tuple(jsc::field("x", &point::x), jsc::field("y", &point::y))};
+};
+
+#ifdef JSC_HAS_COROUTINES
+jsc::task<double> sum_of_squares(jsc::event_loop& loop, jsc::object square) {
+  const auto a{co_await jsc::resolve(loop, square.call(3))};
+  const auto b{co_await jsc::resolve(loop, square.call(4))};
+  co_return a.to_number() + b.to_number();
+}
+#endif
+
 int main() {
   jsc::context ctx;
   const auto result1 = ctx.eval_script("1 + 2 + 3").to_number();
@@ -17,11 +38,24 @@ int main() {
   ctx.root()["world"] = 10;
   ctx.root()["x"] = ctx.obj();
   ctx.root()["x"].get().to_object()[12] = 30;
+  ctx.root()["x"].get().to_object()[0] = 1;
   const auto result2 = ctx.eval_script("1 + 2 + world + x[12]").to_number();
   if (ctx.ok()) {
     std::cout << result2 << "\n";
   }
 
+  auto outer = ctx.undefined();
+  {
+    jsc::handle_scope scope{ctx};
+    ctx.root()["x"].get().to_object()[12] = 40;
+    std::cout << ctx.root()["x"].get().to_object()[12].get().to_number()
+              << "\n";
+    std::cout << ctx.root()[JSC_KEY("world")].exists() << "\n";
+    outer = ctx.eval_script("({kept: 1})");
+  }
+  ctx.collect_garbage();
+  std::cout << outer.to_object()["kept"].get().to_number() << "\n";
+
   ctx.clear_exception();
   const auto result3 =
       ctx.eval_script("x => x**2").to_object().call(10).to_number();
@@ -46,12 +80,70 @@ int main() {
     std::cout << result4 << "\n";
   }
 
+  ctx.clear_exception();
+  ctx.root()["run_native"] = ctx.native([](const jsc::native_call& call) {
+    if (call.size() != 1) {
+      call.throw_error("Expected one argument!");
+    }
+    return call.get<double>(0) + 10;
+  });
+  const auto result41 = ctx.eval_script("run_native(15)").to_number();
+  if (ctx.ok()) {
+    std::cout << result41 << "\n";
+  }
+
+  ctx.clear_exception();
+  ctx.root()["repeat"] = ctx.function([](const std::string& str, int times) {
+    std::string result;
+    for (int i = 0; i < times; i++) {
+      result += str;
+    }
+    return result;
+  });
+  const auto result42 = ctx.eval_script("repeat('ab', 3)").to_string();
+  if (ctx.ok()) {
+    std::cout << result42 << "\n";
+  }
+
   ctx.clear_exception();
   ctx.eval_script("run(15, 16)");
   const auto result5 =
       ctx.get_exception().to_object()["stack"].get().to_string();
   std::cout << result5 << "\n";
 
+  ctx.clear_exception();
+  ctx.set_error_mode(jsc::error_mode::exception);
+  try {
+    ctx.eval_script("null.property");
+  } catch (const jsc::js_error& error) {
+    std::cout << error.what() << "\n";
+  }
+  try {
+    ctx.eval_file("missing.js");
+  } catch (const jsc::js_error& error) {
+    std::cout << error.what() << "\n";
+  }
+  try {
+    const jsc::time_limit limit{ctx, std::chrono::milliseconds{50}};
+    ctx.eval_script("for (;;) {}");
+  } catch (const jsc::execution_terminated& error) {
+    std::cout << "Terminated: " << error.what() << "\n";
+  }
+  ctx.set_error_mode(jsc::error_mode::store);
+
+  // Stopped inside a native callback whose wrapper only stores the error
+  ctx.clear_exception();
+  ctx.root()["spin"] = ctx.native([](const jsc::native_call& call) {
+    jsc::context inner{JSContextGetGlobalContext(call.ctx)};
+    inner.eval_script("for (;;) {}");
+  });
+  {
+    const jsc::time_limit limit{ctx, std::chrono::milliseconds{50}};
+    ctx.eval_script("try { spin(); } catch (e) {} globalThis.survived = 1;");
+  }
+  std::cout << ctx.terminated() << " " << ctx.root()["survived"].exists()
+            << "\n";
+
   ctx.clear_exception();
   const auto result61 = ctx.eval_script("run.constructor.name").to_string();
   if (ctx.ok()) {
@@ -68,17 +160,193 @@ int main() {
   std::cout << ctx.root()["run"].get().to_object().is_function() << " "
             << ctx.root()["cont"].get().to_object().is_function() << "\n";
 
+  jsc::class_binding<point> point_binding{"Point"};
+  point_binding.method<&point::length>("length")
+      .property<&point::x>("x")
+      .property<&point::y>("y");
+  ctx.root()["pt"] = ctx.instance(point_binding, 3.0, 4.0);
+  const auto result66 =
+      ctx.eval_script("pt.x = 6; pt.y = 8; pt.length()").to_number();
+  if (ctx.ok()) {
+    std::cout << result66 << "\n";
+  }
+  const auto result74 =
+      ctx.eval_script("try { pt.length.call(cont); } catch (e) { e.name }")
+          .to_string();
+  if (ctx.ok()) {
+    std::cout << result74 << "\n";
+  }
+
   auto str_container = ctx.container<std::string>("Hello");
   std::cout << str_container.is_container<std::string>() << " "
             << *str_container.get_contained<std::string>() << "\n";
 
   ctx.clear_exception();
-  std::ifstream input{"../test/sudoku_v1.js"};
-  std::ostringstream buffer;
-  buffer << input.rdbuf();
-  std::cout << buffer.str().length() << "\n";
+  ctx.root()["samples"] = ctx.typed_array(std::vector<float>{1.5f, 2.5f, 3.f});
+  const auto result64 =
+      ctx.eval_script("samples[1] = 4; samples.reduce((a, b) => a + b)")
+          .to_number();
+  if (ctx.ok()) {
+    const auto samples =
+        ctx.root()["samples"].get().to_object().typed_array_data<float>();
+    std::cout << result64 << " " << samples[1] << "\n";
+  }
+
+  ctx.clear_exception();
+  ctx.root()["names"] = ctx.array(std::vector<std::string>{"a", "b", "c"});
+  const auto result65 = ctx.eval_script("names.map(n => n.length * 2)")
+                            .to_object()
+                            .to_vector<double>();
+  if (ctx.ok()) {
+    std::cout << result65.size() << " " << result65[2] << "\n";
+  }
+
+  ctx.clear_exception();
+  const auto result63 = ctx.eval_script(u"\"你好\".length").to_number();
+  if (ctx.ok()) {
+    std::cout << result63 << "\n";
+  }
+
+  ctx.clear_exception();
+  const jsc::script counter_script{
+      "var counter = (typeof counter === 'number' ? counter : 0) + 1;",
+      "counter.js"};
+  for (int i = 0; i < 3; i++) {
+    ctx.eval_script(counter_script);
+  }
+  const auto doubled = ctx.compile(jsc::script{"return counter * 2;"});
+  const auto result68 = doubled.call().to_number();
+  if (ctx.ok()) {
+    std::cout << result68 << "\n";
+  }
+
+  ctx.clear_exception();
+  {
+    jsc::event_loop loop{ctx};
+    ctx.root()["square_later"] =
+        ctx.native([&loop](const jsc::native_call& call) {
+          const auto x{call.get<double>(0)};
+          return loop.defer([x] { return x * x; }).ref();
+        });
+    ctx.eval_script(
+        "var log = [];"
+        "setTimeout(tag => log.push(tag), 5, 'timeout');"
+        "square_later(12).then(x => log.push(x));"
+        "Promise.resolve('micro').then(m => log.push(m));"
+        "clearTimeout(undefined); clearTimeout(-1);");
+#ifdef JSC_HAS_COROUTINES
+    const auto square{ctx.root()["square_later"].get().to_object()};
+    ctx.root()["sum"] = jsc::start(loop, sum_of_squares(loop, square));
+    ctx.eval_script("sum.then(x => log.push(x));");
+#endif
+    loop.run();
+    const auto result69 = ctx.eval_script("log.sort().join(' ')").to_string();
+    if (ctx.ok()) {
+      std::cout << result69 << "\n";
+    }
+  }
+
+  ctx.clear_exception();
+  {
+    jsc::context other;
+    const auto graph = ctx.eval_script(
+        "var g = {name: 'graph', list: [1, 2.5, 'x'],"
+        "         bytes: new Uint8Array([1, 2, 3])};"
+        "g.self = g; g");
+    other.root()["g"] = other.deserialize(ctx.serialize(graph));
+    const auto result70 =
+        other.eval_script("g.self === g && g.list[1] + g.bytes[2]")
+            .to_number();
+    if (ctx.ok() && other.ok()) {
+      std::cout << result70 << "\n";
+    }
+    const auto nested = ctx.eval_script(
+        "let deep = {}; for (let i = 0; i < 10000; i++) deep = {deep}; deep");
+    const auto clone71 = ctx.serialize(nested);
+    std::cout << clone71.empty() << " " << ctx.ok() << "\n";
+    ctx.clear_exception();
+    const auto sparse = ctx.eval_script("var s = [1]; s[4e9] = 2; s");
+    other.root()["s"] = other.deserialize(ctx.serialize(sparse));
+    const auto sparse_copy =
+        other.eval_script("[s.length, 2 in s, s[4e9]].join()").to_string();
+    if (ctx.ok() && other.ok()) {
+      std::cout << sparse_copy << "\n";
+    }
+  }
+
+  ctx.clear_exception();
+  ctx.root()["config"] = ctx.from_json(R"({"name": "demo", "sizes": [1, 2]})");
+  ctx.root()["path"] =
+      ctx.from_native(std::vector<point>{{0, 0}, {3, 4}, {6, 8}});
+  const auto result71 =
+      ctx.eval_script("({name: config.name, last: path[2]})").to_json();
+  if (ctx.ok()) {
+    std::cout << result71 << "\n";
+  }
+
+  ctx.clear_exception();
+  ctx.root()["origin"] = point{1, 2};
+  const auto result72 =
+      ctx.eval_script("({x: origin.x + 2, y: origin.y * 2})").as<point>();
+  const auto result73 =
+      ctx.eval_script("({a: [1, null], b: []})")
+          .as<std::map<std::string, std::vector<std::optional<double>>>>();
+  if (ctx.ok()) {
+    std::cout << result72.length() << " " << result73.at("a").size() << " "
+              << result73.at("a")[1].has_value() << "\n";
+  }
+
+  ctx.clear_exception();
+  const auto huge =
+      ctx.eval_script("({length: 4e9})").as<std::vector<double>>();
+  std::cout << huge.size() << " " << ctx.ok() << "\n";
+
+  ctx.collect_every(64 << 20);
+  ctx.root()["history"] = ctx.container<std::vector<double>>(
+      std::vector<double>(1 << 16));
+  const auto stats = ctx.memory_usage();
+  std::cout << (stats.container_bytes >= (1 << 19)) << " "
+            << stats.object_count << "\n";
+  ctx.collect_garbage();
+
+  jsc::context_pool::options pool_options;
+  pool_options.size = 2;
+  pool_options.bootstrap = "var base = 100;";
+  jsc::context_pool pool{pool_options};
+  {
+    auto pooled = pool.acquire();
+    const auto result67 = pooled->eval_script("base + 1").to_number();
+    if (pooled->ok()) {
+      std::cout << result67 << " " << pool.available() << "\n";
+    }
+  }
+
+  ctx.clear_exception();
+  jsc::profiler profiler{std::chrono::microseconds{500}};
+  profiler.start();
+  ctx.eval_script(
+      "function fib(n) { return n < 2 ? n : fib(n - 1) + fib(n - 2); }"
+      "repeat('ab', 3); fib(20);",
+      "profiled.js");
+  profiler.stop();
+  for (const auto& entry : profiler.entries()) {
+    std::cout << entry.name << " " << entry.calls << " "
+              << entry.self.count() << "\n";
+  }
+  std::cout << profiler.folded();
+
+  jsc::reset_wrapper_counters();
+  jsc::trace_recorder trace;
+  trace.start();
+  ctx.eval_script("repeat('x', 2)", "traced.js");
+  trace.stop();
+  const auto counters = jsc::read_wrapper_counters();
+  std::cout << counters.strings_created << " " << counters.try_throwables
+            << " " << trace.json() << "\n";
+
+  ctx.clear_exception();
   auto start = std::chrono::high_resolution_clock::now();
-  ctx.eval_script(buffer.str(), "sudoku_v1.js");
+  ctx.eval_file("../test/sudoku_v1.js");
   if (!ctx.ok()) {
     std::cout << "Timed execution: exception!\n";
   } else {
@@ -88,7 +356,7 @@ int main() {
     std::cout << duration.count() << "\n";
   }
 
-  ctx.eval_script(u8"\"你好世界\"; throw new Error();");
+  ctx.eval_script("\"你好世界\"; throw new Error();");
   const auto result7 =
       ctx.get_exception().to_object()["stack"].get().to_string();
   std::cout << result7 << "\n";